@@ -470,6 +470,43 @@ namespace wr::d3d12
 		cmd_list->m_native->ResourceBarrier(static_cast<unsigned int>(barriers.size()), barriers.data());
 	}
 
+	void Transition(CommandList* cmd_list, std::vector<ResourceBarrier> const & barriers)
+	{
+		if (barriers.empty())
+		{
+			return;
+		}
+
+		std::vector<CD3DX12_RESOURCE_BARRIER> n_barriers;
+		n_barriers.reserve(barriers.size());
+
+		for (auto const & barrier : barriers)
+		{
+			auto flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+			switch (barrier.m_split)
+			{
+			case ResourceBarrierSplit::BEGIN:
+				flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+				break;
+			case ResourceBarrierSplit::END:
+				flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+				break;
+			default:
+				break;
+			}
+
+			n_barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
+				reinterpret_cast<ID3D12Resource*>(barrier.m_resource),
+				(D3D12_RESOURCE_STATES)barrier.m_from,
+				(D3D12_RESOURCE_STATES)barrier.m_to,
+				D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+				flags
+			));
+		}
+
+		cmd_list->m_native->ResourceBarrier(static_cast<unsigned int>(n_barriers.size()), n_barriers.data());
+	}
+
 	void Transition(CommandList* cmd_list, IndirectCommandBuffer* buffer, ResourceState from, ResourceState to, uint32_t frame_idx)
 	{
 		CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
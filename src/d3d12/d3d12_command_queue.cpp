@@ -38,6 +38,15 @@ namespace wr::d3d12
 	}
 
 	void Execute(CommandQueue* cmd_queue, std::vector<CommandList*> const & cmd_lists, Fence* fence)
+	{
+		Execute(cmd_queue, cmd_lists);
+
+		fence->m_fence_value++;
+		Signal(fence, cmd_queue);
+
+	}
+
+	void Execute(CommandQueue* cmd_queue, std::vector<CommandList*> const & cmd_lists)
 	{
 		std::vector<ID3D12CommandList*> native_lists;
 		native_lists.resize(cmd_lists.size());
@@ -47,10 +56,12 @@ namespace wr::d3d12
 		}
 
 		cmd_queue->m_native->ExecuteCommandLists(static_cast<unsigned int>(native_lists.size()), native_lists.data());
+	}
 
-		fence->m_fence_value++;
-		Signal(fence, cmd_queue);
-
+	void Wait(CommandQueue* cmd_queue, Fence* fence, std::uint64_t value)
+	{
+		TRY_M(cmd_queue->m_native->Wait(fence->m_native, value),
+			"Failed to wait for fence on the command queue");
 	}
 
 	void Destroy(CommandQueue* cmd_queue)
@@ -23,6 +23,7 @@
 #include "d3d12_constant_buffer_pool.hpp"
 #include "d3d12_dynamic_descriptor_heap.hpp"
 #include "d3d12_descriptors_allocations.hpp"
+#include "../frame_graph/resource_barriers.hpp"
 
 namespace wr::d3d12
 {
@@ -37,6 +38,8 @@ namespace wr::d3d12
 	// CommandQueue
 	[[nodiscard]] CommandQueue* CreateCommandQueue(Device* device, CmdListType type);
 	void Execute(CommandQueue* cmd_queue, std::vector<CommandList*> const & cmd_lists, Fence* fence);
+	void Execute(CommandQueue* cmd_queue, std::vector<CommandList*> const & cmd_lists);
+	void Wait(CommandQueue* cmd_queue, Fence* fence, std::uint64_t value); // GPU side wait.
 	void Destroy(CommandQueue* cmd_queue);
 	void SetName(CommandQueue* cmd_queue, std::wstring name);
 
@@ -81,6 +84,7 @@ namespace wr::d3d12
 	void Transition(CommandList* cmd_list, std::vector<TextureResource*> const& textures, ResourceState from, ResourceState to);
 	void Transition(CommandList* cmd_list, IndirectCommandBuffer* buffer, ResourceState from, ResourceState to, uint32_t frame_idx);
 	void Transition(CommandList* cmd_list, StagingBuffer* buffer, ResourceState from, ResourceState to);
+	void Transition(CommandList* cmd_list, std::vector<ResourceBarrier> const & barriers); // Resources are `ID3D12Resource*`'s.
 	void TransitionDepth(CommandList* cmd_list, RenderTarget* render_target, ResourceState from, ResourceState to);
 	void Alias(CommandList* cmd_list, TextureResource* resource_before, TextureResource* resource_after);
 	void UAVBarrier(CommandList* cmd_list, std::vector<TextureResource*> const & resources);
@@ -17,6 +17,7 @@
 
 #include "../util/defines.hpp"
 #include "../util/log.hpp"
+#include "../util/parallel.hpp"
 #include "../scene_graph/scene_graph.hpp"
 #include "../frame_graph/frame_graph.hpp"
 #include "../window.hpp"
@@ -60,6 +61,11 @@ namespace wr
 
 	D3D12RenderSystem::~D3D12RenderSystem()
 	{
+		WaitForPendingSubmission();
+		delete m_submission_thread;
+
+		EvictCachedRenderTargets(0);
+
 		for (int i = 0; i < m_structured_buffer_pools.size(); ++i)
 		{
 			m_structured_buffer_pools[i].reset();
@@ -86,6 +92,9 @@ namespace wr
 			delete fence;
 		}
 
+		d3d12::Destroy(m_direct_queue_fence);
+		d3d12::Destroy(m_compute_queue_fence);
+
 		DestroyShaderRegistry();
 		DestroyRootSignatureRegistry();
 		DestroyPipelineRegistry();
@@ -118,6 +127,7 @@ namespace wr
 		if (window.has_value())
 		{
 			m_render_window = d3d12::CreateRenderWindow(m_device, window.value()->GetWindowHandle(), m_direct_queue, d3d12::settings::num_back_buffers);
+			UpdateFrameIdx();
 		}
 
 		PrepareShaderRegistry();
@@ -132,6 +142,16 @@ namespace wr
 			SetName(m_fences[i], (L"Fence " + std::to_wstring(i)));
 		}
 
+		if constexpr (d3d12::settings::use_pipelined_submission)
+		{
+			m_submission_thread = new util::ThreadPool(1);
+		}
+
+		m_direct_queue_fence = d3d12::CreateFence(m_device);
+		m_compute_queue_fence = d3d12::CreateFence(m_device);
+		SetName(m_direct_queue_fence, L"Direct Queue Fence");
+		SetName(m_compute_queue_fence, L"Compute Queue Fence");
+
 		// Create viewport
 		m_viewport = d3d12::CreateViewport(window.has_value() ? window.value()->GetWidth() : 400, window.has_value() ? window.value()->GetHeight() : 400);
 
@@ -178,10 +198,19 @@ namespace wr
 
 	CPUTextures D3D12RenderSystem::Render(SceneGraph& scene_graph, FrameGraph& frame_graph)
 	{
+		// The previous frame has to be presented before we know the index of this frame.
+		// Done once here on the main thread, the tasks and the pools only read the index during the frame.
+		WaitForPendingSubmission();
+
+		// Render targets that no frame graph picked up for a while are released.
+		m_frame_count++;
+		EvictCachedRenderTargets(d3d12::settings::render_target_cache_idle_frames);
+
+		// The skybox tasks only fingerprint the skybox node, a new texture on the same node has to run them again.
 		if (m_skybox_changed)
 		{
-			frame_graph.SetShouldExecute<wr::EquirectToCubemapTaskData>(true);
-			frame_graph.SetShouldExecute<wr::CubemapConvolutionTaskData>(true);
+			frame_graph.InvalidateFingerprint<wr::EquirectToCubemapTaskData>();
+			frame_graph.InvalidateFingerprint<wr::CubemapConvolutionTaskData>();
 
 			m_skybox_changed = false;
 		}
@@ -273,28 +302,66 @@ namespace wr
 
 		frame_graph.Execute(scene_graph);
 
-		auto cmd_lists = frame_graph.GetAllCommandLists<d3d12::CommandList>();
-		std::vector<d3d12::CommandList*> n_cmd_lists;
-		n_cmd_lists.reserve(cmd_lists.size());
+		if constexpr (settings::use_async_compute)
+		{
+			auto plan = frame_graph.GetQueueSubmissionPlan();
 
-		n_cmd_lists.push_back(m_direct_cmd_list);
+			std::vector<std::vector<d3d12::CommandList*>> cmd_lists;
+			cmd_lists.reserve(plan.m_submissions.size());
+			for (auto const & submission : plan.m_submissions)
+			{
+				cmd_lists.push_back(frame_graph.GetCommandLists<d3d12::CommandList>(submission));
+			}
 
-		for (auto& list : cmd_lists)
-		{
-			n_cmd_lists.push_back(list);
+			// Reset the batches.
+			ResetBatches(scene_graph);
+
+			SubmitFrame([this, plan = std::move(plan), cmd_lists = std::move(cmd_lists), frame_idx]()
+			{
+				ExecuteQueueSubmissions(plan, cmd_lists, frame_idx);
+			});
 		}
+		else if constexpr (d3d12::settings::num_tasks_per_streamed_submission > 0)
+		{
+			// The previous frame was submitted by `WaitForPendingSubmission`, so this frame can go straight to the queue.
+			d3d12::Execute(m_direct_queue, { m_direct_cmd_list });
 
-		// Reset the batches.
-		ResetBatches(scene_graph);
+			// Submit the tasks while the later tasks are still recording.
+			frame_graph.StreamCommandLists<d3d12::CommandList>(d3d12::settings::num_tasks_per_streamed_submission, [this](std::vector<d3d12::CommandList*> const & cmd_lists)
+			{
+				d3d12::Execute(m_direct_queue, cmd_lists);
+			});
 
-		d3d12::Execute(m_direct_queue, n_cmd_lists, m_fences[frame_idx]);
+			// Reset the batches.
+			ResetBatches(scene_graph);
 
-		if (m_render_window.has_value())
-		{
-			d3d12::Present(m_render_window.value());
+			SubmitFrame([this, frame_idx]()
+			{
+				m_fences[frame_idx]->m_fence_value++;
+				d3d12::Signal(m_fences[frame_idx], m_direct_queue);
+			});
 		}
+		else
+		{
+			auto cmd_lists = frame_graph.GetAllCommandLists<d3d12::CommandList>();
+			std::vector<d3d12::CommandList*> n_cmd_lists;
+			n_cmd_lists.reserve(cmd_lists.size());
+
+			n_cmd_lists.push_back(m_direct_cmd_list);
+
+			for (auto& list : cmd_lists)
+			{
+				n_cmd_lists.push_back(list);
+			}
 
-		m_bound_model_pool = nullptr;
+			// Reset the batches.
+			ResetBatches(scene_graph);
+
+			SubmitFrame([this, n_cmd_lists = std::move(n_cmd_lists), frame_idx]()
+			{
+				d3d12::Execute(m_direct_queue, n_cmd_lists, m_fences[frame_idx]);
+			});
+		}
 
 		for (int i = 0; i < m_model_pools.size(); ++i)
 		{
@@ -308,12 +375,95 @@ namespace wr
 		return frame_graph.GetOutputTexture();
 	}
 
+	void D3D12RenderSystem::SubmitFrame(std::function<void()> submit)
+	{
+		auto submit_and_present = [this, submit = std::move(submit)]()
+		{
+			submit();
+
+			if (m_render_window.has_value())
+			{
+				d3d12::Present(m_render_window.value());
+			}
+		};
+
+		if constexpr (d3d12::settings::use_pipelined_submission)
+		{
+			// Let the submission thread submit and present so the caller can continue with the next frame.
+			m_pending_submission = m_submission_thread->Enqueue(std::move(submit_and_present));
+		}
+		else
+		{
+			submit_and_present();
+			UpdateFrameIdx();
+		}
+	}
+
+	void D3D12RenderSystem::WaitForPendingSubmission()
+	{
+		if (m_pending_submission.valid())
+		{
+			m_pending_submission.get();
+		}
+
+		UpdateFrameIdx();
+	}
+
+	void D3D12RenderSystem::UpdateFrameIdx()
+	{
+		m_frame_idx = m_render_window.has_value() ? m_render_window.value()->m_frame_idx : 0;
+	}
+
+	void D3D12RenderSystem::ExecuteQueueSubmissions(QueueSubmissionPlan const & plan, std::vector<std::vector<d3d12::CommandList*>> const & cmd_lists, unsigned int frame_idx)
+	{
+		// The pre render commands are used by both queues.
+		d3d12::Execute(m_direct_queue, { m_direct_cmd_list }, m_direct_queue_fence);
+		d3d12::Wait(m_compute_queue, m_direct_queue_fence, m_direct_queue_fence->m_fence_value);
+
+		std::vector<std::uint64_t> fence_values(plan.m_submissions.size(), 0u);
+		for (std::size_t i = 0; i < plan.m_submissions.size(); ++i)
+		{
+			auto const & submission = plan.m_submissions[i];
+			const bool is_compute = submission.m_queue == SubmissionQueue::COMPUTE;
+			auto queue = is_compute ? m_compute_queue : m_direct_queue;
+			auto fence = is_compute ? m_compute_queue_fence : m_direct_queue_fence;
+
+			if (submission.m_wait_for.has_value())
+			{
+				auto other_fence = is_compute ? m_direct_queue_fence : m_compute_queue_fence;
+				d3d12::Wait(queue, other_fence, fence_values[submission.m_wait_for.value()]);
+			}
+
+			if (submission.m_signal)
+			{
+				d3d12::Execute(queue, cmd_lists[i], fence);
+				fence_values[i] = fence->m_fence_value;
+			}
+			else
+			{
+				d3d12::Execute(queue, cmd_lists[i]);
+			}
+		}
+
+		// The frame fence is signaled on the direct queue so it has to wait for the remaining compute work.
+		if (plan.m_wait_at_end.has_value())
+		{
+			d3d12::Wait(m_direct_queue, m_compute_queue_fence, fence_values[plan.m_wait_at_end.value()]);
+		}
+
+		m_fences[frame_idx]->m_fence_value++;
+		d3d12::Signal(m_fences[frame_idx], m_direct_queue);
+	}
+
 	void D3D12RenderSystem::Resize(std::uint32_t width, std::uint32_t height)
 	{
+		WaitForPendingSubmission();
+
 		d3d12::ResizeViewport(m_viewport, (int)width, (int)height);
 		if (m_render_window.has_value())
 		{
 			d3d12::Resize(m_render_window.value(), m_device, width, height);
+			UpdateFrameIdx();
 		}
 	}
 
@@ -360,6 +510,8 @@ namespace wr
 
 	void D3D12RenderSystem::WaitForAllPreviousWork()
 	{
+		WaitForPendingSubmission();
+
 		for (auto& fence : m_fences)
 		{
 			d3d12::WaitFor(fence);
@@ -379,7 +531,8 @@ namespace wr
 
 	CommandList* D3D12RenderSystem::GetComputeCommandList(unsigned int num_allocators)
 	{
-		return d3d12::CreateCommandList(m_device, num_allocators, CmdListType::CMD_LIST_DIRECT);
+		// Compute tasks only get a compute command list when they are submitted to the compute queue.
+		return d3d12::CreateCommandList(m_device, num_allocators, settings::use_async_compute ? CmdListType::CMD_LIST_COMPUTE : CmdListType::CMD_LIST_DIRECT);
 	}
 
 	CommandList* D3D12RenderSystem::GetCopyCommandList(unsigned int num_allocators)
@@ -419,7 +572,7 @@ namespace wr
 
 			if (properties.m_width.Get().has_value() || properties.m_height.Get().has_value())
 			{
-				auto retval = d3d12::CreateRenderTarget(m_device, 
+				auto retval = AcquireRenderTarget(
 					static_cast<std::uint32_t>(properties.m_width.Get().value() * properties.m_resolution_scale.Get()),
 					static_cast<std::uint32_t>(properties.m_height.Get().value() * properties.m_resolution_scale.Get()),
 					desc);
@@ -428,7 +581,7 @@ namespace wr
 			}
 			else if (m_window.has_value())
 			{
-				auto retval = d3d12::CreateRenderTarget(m_device, 
+				auto retval = AcquireRenderTarget(
 					static_cast<std::uint32_t>(m_window.value()->GetWidth() * properties.m_resolution_scale.Get()),
 					static_cast<std::uint32_t>(m_window.value()->GetHeight() * properties.m_resolution_scale.Get()),
 					desc);
@@ -443,6 +596,61 @@ namespace wr
 		}
 	}
 
+	RenderTargetAllocationInfo D3D12RenderSystem::GetRenderTargetAllocationInfo(RenderTargetProperties properties)
+	{
+		if (properties.m_is_render_window)
+		{
+			return {};
+		}
+
+		std::uint32_t width = 0;
+		std::uint32_t height = 0;
+
+		if (properties.m_width.Get().has_value() || properties.m_height.Get().has_value())
+		{
+			width = static_cast<std::uint32_t>(properties.m_width.Get().value() * properties.m_resolution_scale.Get());
+			height = static_cast<std::uint32_t>(properties.m_height.Get().value() * properties.m_resolution_scale.Get());
+		}
+		else if (m_window.has_value())
+		{
+			width = static_cast<std::uint32_t>(m_window.value()->GetWidth() * properties.m_resolution_scale.Get());
+			height = static_cast<std::uint32_t>(m_window.value()->GetHeight() * properties.m_resolution_scale.Get());
+		}
+		else
+		{
+			LOGW("Render target doesn't have a width or height specified. And there is no window to take the window size from.");
+			return {};
+		}
+
+		// Describe the resources the same way `d3d12::CreateRenderTarget` creates them.
+		std::vector<D3D12_RESOURCE_DESC> resource_descs;
+		for (auto i = 0u; i < properties.m_num_rtv_formats.Get(); i++)
+		{
+			resource_descs.push_back(CD3DX12_RESOURCE_DESC::Tex2D((DXGI_FORMAT)properties.m_rtv_formats.Get()[i],
+				width,
+				height,
+				1,
+				1,
+				1,
+				0,
+				D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS));
+		}
+
+		if (properties.m_create_dsv_buffer)
+		{
+			resource_descs.push_back(CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R32_TYPELESS, width, height, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL));
+		}
+
+		if (resource_descs.empty())
+		{
+			return {};
+		}
+
+		auto allocation_info = m_device->m_native->GetResourceAllocationInfo(0, static_cast<UINT>(resource_descs.size()), resource_descs.data());
+
+		return { allocation_info.SizeInBytes, allocation_info.Alignment };
+	}
+
 	void D3D12RenderSystem::SetRenderTargetName(RenderTarget* render_target, std::wstring const& name)
 	{
 		d3d12::SetName(static_cast<d3d12::RenderTarget*>(render_target), name);
@@ -457,10 +665,71 @@ namespace wr
 	}
 	void D3D12RenderSystem::DestroyRenderTarget(RenderTarget** render_target)
 	{
-		Destroy((d3d12::RenderTarget*)*render_target);
+		auto n_render_target = static_cast<d3d12::RenderTarget*>(*render_target);
+
+		// The frame graph waits for the GPU before releasing render targets, so they can be handed out again right away.
+		if constexpr (d3d12::settings::render_target_cache_idle_frames > 0)
+		{
+			if (n_render_target)
+			{
+				m_render_target_cache.push_back({ n_render_target, m_frame_count });
+			}
+		}
+		else
+		{
+			Destroy(n_render_target);
+		}
+
 		*render_target = nullptr;
 	}
 
+	d3d12::RenderTarget* D3D12RenderSystem::AcquireRenderTarget(std::uint32_t width, std::uint32_t height, d3d12::desc::RenderTargetDesc const & desc)
+	{
+		auto matches = [width, height, &desc](d3d12::RenderTarget* render_target)
+		{
+			auto const & create_info = render_target->m_create_info;
+
+			// The initial state is the state the render target was left in, so it has to match as well.
+			return render_target->m_width == width
+				&& render_target->m_height == height
+				&& create_info.m_initial_state == desc.m_initial_state
+				&& create_info.m_create_dsv_buffer == desc.m_create_dsv_buffer
+				&& (!desc.m_create_dsv_buffer || create_info.m_dsv_format == desc.m_dsv_format)
+				&& create_info.m_num_rtv_formats == desc.m_num_rtv_formats
+				&& std::equal(desc.m_rtv_formats.begin(), desc.m_rtv_formats.begin() + desc.m_num_rtv_formats, create_info.m_rtv_formats.begin());
+		};
+
+		// Prefer the most recently released render target.
+		for (auto it = m_render_target_cache.rbegin(); it != m_render_target_cache.rend(); ++it)
+		{
+			if (matches(it->m_render_target))
+			{
+				auto render_target = it->m_render_target;
+				m_render_target_cache.erase(std::next(it).base());
+
+				return render_target;
+			}
+		}
+
+		return d3d12::CreateRenderTarget(m_device, width, height, desc);
+	}
+
+	void D3D12RenderSystem::EvictCachedRenderTargets(std::uint64_t max_idle_frames)
+	{
+		auto evicted = std::remove_if(m_render_target_cache.begin(), m_render_target_cache.end(), [this, max_idle_frames](CachedRenderTarget const & cached)
+		{
+			if (m_frame_count - cached.m_released_frame < max_idle_frames)
+			{
+				return false;
+			}
+
+			Destroy(cached.m_render_target);
+			return true;
+		});
+
+		m_render_target_cache.erase(evicted, m_render_target_cache.end());
+	}
+
 	void D3D12RenderSystem::RequestFullscreenChange(bool fullscreen_state)
 	{
 		m_requested_fullscreen_state = fullscreen_state;
@@ -528,6 +797,22 @@ namespace wr
 		}
 	}
 
+	void D3D12RenderSystem::ContinueRenderTask(CommandList* cmd_list, std::pair<RenderTarget*, RenderTargetProperties> render_target)
+	{
+		auto n_cmd_list = static_cast<d3d12::CommandList*>(cmd_list);
+		auto n_render_target = static_cast<d3d12::RenderTarget*>(render_target.first);
+
+		// The render target is already in the execute state and cleared by the command list that started the task.
+		if (render_target.second.m_is_render_window)
+		{
+			d3d12::BindRenderTargetVersioned(n_cmd_list, n_render_target, GetFrameIdx(), false, false);
+		}
+		else
+		{
+			d3d12::BindRenderTarget(n_cmd_list, n_render_target, false, false);
+		}
+	}
+
 	void D3D12RenderSystem::StartComputeTask(CommandList * cmd_list, std::pair<RenderTarget*, RenderTargetProperties> render_target)
 	{
 	}
@@ -568,6 +853,13 @@ namespace wr
 		}
 	}
 
+	void D3D12RenderSystem::RecordResourceBarriers(CommandList* cmd_list, std::vector<ResourceBarrier> const & barriers)
+	{
+		auto n_cmd_list = static_cast<d3d12::CommandList*>(cmd_list);
+
+		d3d12::Transition(n_cmd_list, barriers);
+	}
+
 	void D3D12RenderSystem::SaveRenderTargetToDisc(std::string const& path, RenderTarget* render_target, unsigned int index)
 	{
 		auto n_render_target = static_cast<d3d12::RenderTarget*>(render_target);
@@ -961,22 +1253,7 @@ namespace wr
 
 	void D3D12RenderSystem::Update_Transforms(SceneGraph& scene_graph, std::shared_ptr<Node>& node)
 	{
-
-		if (node->RequiresTransformUpdate(GetFrameIdx()))
-		{
-			node->UpdateTransform();
-			node->SignalTransformUpdate(GetFrameIdx());
-		}
-
-		auto& children = node->m_children;
-		auto it = children.begin();
-
-		while (it != children.end())
-		{
-			Update_Transforms(scene_graph, *it);
-			++it;
-		}
-
+		scene_graph.GetTransformStore().Update(node, GetFrameIdx());
 	}
 
 	void D3D12RenderSystem::Delete_Skybox(SceneGraph& scene_graph, std::shared_ptr<SkyboxNode>& skybox_node)
@@ -1024,15 +1301,19 @@ namespace wr
 
 	void D3D12RenderSystem::Update_MeshNodes(std::vector<std::shared_ptr<MeshNode>>& nodes)
 	{
-		for (auto& node : nodes)
+		const auto frame_idx = GetFrameIdx();
+
+		// Nodes only touch their own AABB and update flags.
+		util::ParallelFor(0, nodes.size(), 256, [&nodes, frame_idx](std::size_t i)
 		{
-			if (!node->RequiresUpdate(GetFrameIdx()))
+			auto& node = nodes[i];
+			if (!node->RequiresUpdate(frame_idx))
 			{
-				continue;
+				return;
 			}
 
-			node->Update(GetFrameIdx());
-		}
+			node->Update(frame_idx);
+		});
 	}
 
 	void D3D12RenderSystem::Update_CameraNodes(std::vector<std::shared_ptr<CameraNode>>& nodes)
@@ -1103,16 +1384,27 @@ namespace wr
 
 	}
 
-	void D3D12RenderSystem::Render_MeshNodes(temp::MeshBatches& batches, CameraNode* camera, CommandList* cmd_list)
+	void D3D12RenderSystem::Render_MeshNodes(temp::MeshBatches& batches, CameraNode* camera, CommandList* cmd_list, std::size_t first_batch, std::size_t num_batches)
 	{
 		auto n_cmd_list = static_cast<d3d12::CommandList*>(cmd_list);
 		auto d3d12_camera_cb = static_cast<D3D12ConstantBufferHandle*>(camera->m_camera_cb);
 	
 		d3d12::BindConstantBuffer(n_cmd_list, d3d12_camera_cb->m_native, 0, GetFrameIdx());
 
+		// The bound state is tracked per call, so multiple command lists can be recorded in parallel.
+		D3D12ModelPool* bound_model_pool = nullptr;
+		std::size_t bound_model_pool_stride = 0;
+		MaterialHandle last_material = { nullptr, 0 };
+
+		first_batch = std::min(first_batch, batches.size());
+		num_batches = std::min(num_batches, batches.size() - first_batch);
+
 		//Render batches
-		for (auto& elem : batches)
+		auto begin = std::next(batches.begin(), first_batch);
+		auto end = std::next(begin, num_batches);
+		for (auto it = begin; it != end; ++it)
 		{
+			auto& elem = *it;
 			auto model = elem.first.first;
 			auto materials = elem.first.second;
 			temp::MeshBatch& batch = elem.second;
@@ -1126,7 +1418,7 @@ namespace wr
 			{
 				auto mesh = model->m_meshes[mesh_i];
 				auto n_mesh = static_cast<D3D12ModelPool*>(model->m_model_pool)->GetMeshData(mesh.first->id);
-				if (model->m_model_pool != m_bound_model_pool || n_mesh->m_vertex_staging_buffer_stride != m_bound_model_pool_stride)
+				if (model->m_model_pool != bound_model_pool || n_mesh->m_vertex_staging_buffer_stride != bound_model_pool_stride)
 				{
 					D3D12ModelPool* model_pool = static_cast<D3D12ModelPool*>(model->m_model_pool);
 
@@ -1141,8 +1433,8 @@ namespace wr
 						0,
 						static_cast<std::uint32_t>(model_pool->GetIndexStagingBuffer()->m_size));
 
-					m_bound_model_pool = static_cast<D3D12ModelPool*>(model->m_model_pool);
-					m_bound_model_pool_stride = n_mesh->m_vertex_staging_buffer_stride;
+					bound_model_pool = static_cast<D3D12ModelPool*>(model->m_model_pool);
+					bound_model_pool_stride = n_mesh->m_vertex_staging_buffer_stride;
 				}
 
 				d3d12::BindDescriptorHeaps(n_cmd_list);
@@ -1154,9 +1446,9 @@ namespace wr
 					material_handle = materials[mesh_i];
 				}
 
-				if (material_handle != m_last_material)
+				if (material_handle != last_material)
 				{
-					m_last_material = material_handle;
+					last_material = material_handle;
 
 					BindMaterial(material_handle, cmd_list);
 				}
@@ -1178,11 +1470,6 @@ namespace wr
 				}
 			}
 		}
-
-		// Reset frame specific variables
-		m_last_material.m_id = 0;
-		m_last_material.m_pool = nullptr;
-
 	}
 
 	void D3D12RenderSystem::BindMaterial(MaterialHandle material_handle, CommandList* cmd_list)
@@ -1281,7 +1568,7 @@ namespace wr
 	{
 		if (m_render_window.has_value())
 		{
-			return m_render_window.value()->m_frame_idx;
+			return m_frame_idx;
 		}
 		else
 		{
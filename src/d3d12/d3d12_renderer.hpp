@@ -16,6 +16,7 @@
 #pragma once
 
 #include "../renderer.hpp"
+#include "../util/thread_pool.hpp"
 
 #include <DirectXMath.h>
 
@@ -213,6 +214,7 @@ namespace wr
 		void SetCommandListName(CommandList* cmd_list, std::wstring const& name);
 		void DestroyCommandList(CommandList* cmd_list);
 		RenderTarget* GetRenderTarget(RenderTargetProperties properties);
+		RenderTargetAllocationInfo GetRenderTargetAllocationInfo(RenderTargetProperties properties);
 		void SetRenderTargetName(RenderTarget* cmd_list, std::wstring const& name);
 		void ResizeRenderTarget(RenderTarget** render_target, std::uint32_t width, std::uint32_t height);
 		void RequestFullscreenChange(bool fullscreen_state);
@@ -222,10 +224,12 @@ namespace wr
 		void CloseCommandList(CommandList* cmd_list);
 		void StartRenderTask(CommandList* cmd_list, std::pair<RenderTarget*, RenderTargetProperties> render_target);
 		void StopRenderTask(CommandList* cmd_list, std::pair<RenderTarget*, RenderTargetProperties> render_target);
+		void ContinueRenderTask(CommandList* cmd_list, std::pair<RenderTarget*, RenderTargetProperties> render_target);
 		void StartComputeTask(CommandList* cmd_list, std::pair<RenderTarget*, RenderTargetProperties> render_target);
 		void StopComputeTask(CommandList* cmd_list, std::pair<RenderTarget*, RenderTargetProperties> render_target);
 		void StartCopyTask(CommandList* cmd_list, std::pair<RenderTarget*, RenderTargetProperties> render_target);
 		void StopCopyTask(CommandList* cmd_list, std::pair<RenderTarget*, RenderTargetProperties> render_target);
+		void RecordResourceBarriers(CommandList* cmd_list, std::vector<ResourceBarrier> const & barriers);
 
 		void InitSceneGraph(SceneGraph& scene_graph);
 
@@ -241,9 +245,15 @@ namespace wr
 
 		void PreparePreRenderCommands(bool clear_frame_buffer, int frame_idx);
 
-		void Render_MeshNodes(temp::MeshBatches& batches, CameraNode* camera, CommandList* cmd_list);
+		void Render_MeshNodes(temp::MeshBatches& batches, CameraNode* camera, CommandList* cmd_list, std::size_t first_batch, std::size_t num_batches);
 		void BindMaterial(MaterialHandle material_handle, CommandList* cmd_list);
 
+		/*! Get the index of the frame that is being recorded. */
+		/*!
+			With `d3d12::settings::use_pipelined_submission` the index only advances when `Render` picks up the presented frame,
+			so between two `Render` calls it's the index of the frame that was recorded last.
+			Doesn't wait for anything, so it can be called from the tasks and the thread pool.
+		*/
 		unsigned int GetFrameIdx();
 		d3d12::RenderWindow* GetRenderWindow();
 
@@ -259,6 +269,16 @@ namespace wr
 		d3d12::CommandQueue* m_compute_queue;
 		d3d12::CommandQueue* m_copy_queue;
 		std::array<d3d12::Fence*, d3d12::settings::num_back_buffers> m_fences;
+		/*! Fences used to synchronize the direct and compute queue when `settings::use_async_compute` is enabled. */
+		d3d12::Fence* m_direct_queue_fence;
+		d3d12::Fence* m_compute_queue_fence;
+
+		/*! Submits and presents the previous frame when `d3d12::settings::use_pipelined_submission` is enabled. */
+		/*! Only the main thread waits for it, see `WaitForPendingSubmission`. */
+		util::ThreadPool* m_submission_thread = nullptr;
+		util::TaskFuture<void> m_pending_submission;
+		/*! Copy of the swap chain's frame index, updated on the main thread when no submission is pending. */
+		unsigned int m_frame_idx = 0;
 
 		d3d12::Viewport m_viewport;
 		d3d12::CommandList* m_direct_cmd_list;
@@ -277,8 +297,6 @@ namespace wr
 
 		std::vector<std::shared_ptr<D3D12StructuredBufferPool>> m_structured_buffer_pools;
 		std::vector<std::shared_ptr<D3D12ModelPool>> m_model_pools;
-		D3D12ModelPool* m_bound_model_pool;
-		std::size_t m_bound_model_pool_stride;
 
 		std::optional<wr::TextureHandle> m_brdf_lut = std::nullopt;
 		bool m_brdf_lut_generated = false;
@@ -294,18 +312,32 @@ namespace wr
 
 	private:
 		void ResetBatches(SceneGraph& sg);
+		void SubmitFrame(std::function<void()> submit);
+		void WaitForPendingSubmission();
+		void UpdateFrameIdx();
+		void ExecuteQueueSubmissions(QueueSubmissionPlan const & plan, std::vector<std::vector<d3d12::CommandList*>> const & cmd_lists, unsigned int frame_idx);
 		void LoadPrimitiveShapes();
 		void CreateDefaultResources();
+		d3d12::RenderTarget* AcquireRenderTarget(std::uint32_t width, std::uint32_t height, d3d12::desc::RenderTargetDesc const & desc);
+		void EvictCachedRenderTargets(std::uint64_t max_idle_frames);
 
 		d3d12::CommandSignature* m_cmd_signature;
 		d3d12::CommandSignature* m_cmd_signature_indexed;
 
 		std::optional<bool> m_requested_fullscreen_state;
 
-		MaterialHandle m_last_material = { nullptr, 0 };
-
 		bool m_skybox_changed = false;
 
+		//! A render target released by a frame graph that can be reused by the next one.
+		struct CachedRenderTarget
+		{
+			d3d12::RenderTarget* m_render_target = nullptr;
+			std::uint64_t m_released_frame = 0;
+		};
+
+		std::vector<CachedRenderTarget> m_render_target_cache;
+		std::uint64_t m_frame_count = 0;
+
 	};
 
 } /* wr */
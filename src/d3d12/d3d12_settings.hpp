@@ -57,6 +57,10 @@ namespace wr::d3d12::settings
 	static const constexpr std::uint32_t num_indirect_draw_commands = 8;		//Allow 8 different meshes non-indexed
 	static const constexpr std::uint32_t num_indirect_index_commands = 32;		//Allow 32 different meshes indexed
 	static const constexpr bool use_bundles = false;
+	static const constexpr bool use_pipelined_submission = false;				//Submit and present on a separate thread so the next frame can start earlier.
+	static const constexpr std::uint32_t num_tasks_per_streamed_submission = 0;	//Submit the frame graph command lists in batches of at least this many tasks as soon as they are recorded. 0 submits them all at once. Ignored with async compute.
+	static const constexpr std::uint32_t render_target_cache_idle_frames = 120;	//Keep released render targets this many frames so a new frame graph can reuse them. 0 destroys them right away.
+	static const constexpr std::uint32_t num_deferred_main_cmd_lists = 4;		//Record the geometry of the deferred main task into this many command lists in parallel. 0 records it on one thread.
 	static const constexpr bool force_dxr_fallback = false;
 	static const constexpr bool disable_rtx = false;
 	static const constexpr bool enable_object_culling = true;
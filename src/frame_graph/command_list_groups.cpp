@@ -0,0 +1,52 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "queue_submissions.hpp"
+#include "command_list_groups.hpp"
+
+namespace wr
+{
+
+	std::vector<std::vector<std::uint32_t>> PlanCommandListGroups(std::vector<CommandListGroupingInfo> const & tasks, CommandListCoalescingPolicy const & policy)
+	{
+		std::vector<std::vector<std::uint32_t>> groups;
+
+		for (std::uint32_t task = 0; task < tasks.size(); ++task)
+		{
+			bool merge = !groups.empty() && tasks[task].m_mergeable && groups.back().size() < policy.m_max_tasks_per_list;
+
+			if (merge)
+			{
+				const auto& previous = tasks[groups.back().back()];
+				merge = previous.m_mergeable
+					&& previous.m_list_type == tasks[task].m_list_type
+					&& previous.m_submission == tasks[task].m_submission
+					&& previous.m_multithreaded == tasks[task].m_multithreaded;
+			}
+
+			if (merge)
+			{
+				groups.back().push_back(task);
+			}
+			else
+			{
+				groups.push_back({ task });
+			}
+		}
+
+		return groups;
+	}
+
+} /* wr */
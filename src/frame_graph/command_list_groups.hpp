@@ -0,0 +1,64 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../settings.hpp"
+#include "../wisprenderer_export.hpp"
+
+namespace wr
+{
+
+	//! Command List Coalescing Policy
+	/*!
+		Controls how many consecutive tasks the frame graph records into a single command list.
+		Fewer, larger command lists reduce the submission and driver overhead.
+		The tasks of a group are recorded one after the other on a single thread, so large groups limit parallel recording.
+	*/
+	struct CommandListCoalescingPolicy
+	{
+		/*! The maximum number of tasks recorded into one command list. 0 and 1 disable coalescing. */
+		std::uint32_t m_max_tasks_per_list = settings::max_coalesced_tasks;
+	};
+
+	/*! Describes a task for `PlanCommandListGroups`. */
+	struct CommandListGroupingInfo
+	{
+		/*! Tasks can only share a command list of the same type. For example the `RenderTaskType` of the task. */
+		std::uint32_t m_list_type = 0u;
+		/*! The queue submission of the task. A command list is submitted at once, so a group can't span submissions. */
+		std::uint32_t m_submission = 0u;
+		/*! Whether the task is recorded on the thread pool. Tasks recorded on the dispatching thread aren't merged with tasks that are not. */
+		bool m_multithreaded = true;
+		/*! False for tasks that can't share their command list, like tasks recording secondary command lists. */
+		bool m_mergeable = true;
+	};
+
+	//! Group consecutive tasks that can share a command list.
+	/*!
+		A group is a run of consecutive mergeable tasks with the same list type, submission and threading.
+		A new group is started when the run reaches `CommandListCoalescingPolicy::m_max_tasks_per_list`.
+		This is pure CPU code and doesn't depend on a render system.
+		\param tasks The tasks that execute, indexed by execution index.
+		\param policy The coalescing policy.
+		\return The groups in execution order. Every group holds the execution indices of its tasks in order.
+	*/
+	WISPRENDERER_EXPORT std::vector<std::vector<std::uint32_t>> PlanCommandListGroups(std::vector<CommandListGroupingInfo> const & tasks, CommandListCoalescingPolicy const & policy);
+
+} /* wr */
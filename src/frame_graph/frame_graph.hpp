@@ -21,10 +21,24 @@
 #include <stack>
 #include <deque>
 #include <future>
-#include <any>
-
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "render_target_aliasing.hpp"
+#include "resource_barriers.hpp"
+#include "queue_submissions.hpp"
+#include "command_list_groups.hpp"
+#include "task_settings.hpp"
+#include "type_indices.hpp"
+#include "frame_graph_profiler.hpp"
 #include "../util/thread_pool.hpp"
 #include "../util/delegate.hpp"
+#include "../util/hash_combine.hpp"
 #include "../renderer.hpp"
 #include "../platform_independend_structs.hpp"
 #include "../settings.hpp"
@@ -36,6 +50,12 @@
 #define FG_MAX_PERFORMANCE
 #endif
 
+// Profiling is enabled in debug builds unless `FG_DISABLE_PROFILING` is defined.
+// Define `FG_ENABLE_PROFILING` to profile release builds.
+#if !defined(FG_MAX_PERFORMANCE) && !defined(FG_DISABLE_PROFILING) && !defined(FG_ENABLE_PROFILING)
+#define FG_ENABLE_PROFILING
+#endif
+
 template<typename ...Ts>
 std::vector<std::reference_wrapper<const std::type_info>> FG_DEPS() {
 	return { (typeid(Ts))... };
@@ -65,8 +85,101 @@ namespace wr
 	//! Typedef for the render task handle.
 	using RenderTaskHandle = std::uint32_t;
 
+	namespace internal
+	{
+		/*! Get the unique index of a task data type. */
+		/*!
+			The index is assigned the first time a type is used and doesn't change afterwards.
+			It allows the frame graph to find a task by its data type with a single array lookup instead of comparing `typeid`'s.
+			The index comes from the registry in the library, so it's the same in every module. Every module only asks for it once.
+		*/
+		template<typename T>
+		inline std::uint32_t GetFrameGraphTypeIndex()
+		{
+			static const std::uint32_t index = RegisterTypeIndex(TypeIndexRegistry::FRAME_GRAPH_TASK, typeid(T));
+			return index;
+		}
+
+		/*! The resource states that only read from a resource. These can be combined into a single state. */
+		constexpr std::uint32_t read_only_resource_states =
+			static_cast<std::uint32_t>(ResourceState::VERTEX_AND_CONSTANT_BUFFER)
+			| static_cast<std::uint32_t>(ResourceState::INDEX_BUFFER)
+			| static_cast<std::uint32_t>(ResourceState::PIXEL_SHADER_RESOURCE)
+			| static_cast<std::uint32_t>(ResourceState::NON_PIXEL_SHADER_RESOURCE)
+			| static_cast<std::uint32_t>(ResourceState::COPY_SOURCE)
+			| static_cast<std::uint32_t>(ResourceState::DEPTH_READ)
+			| static_cast<std::uint32_t>(ResourceState::INDIRECT_ARGUMENT);
+
+		/*! State shared between the threads of a `FrameGraph::RecordParallel` call. */
+		/*!
+			Threads grab chunks until none are left. A thread that starts after the recording finished doesn't find a chunk,
+			so the state is reference counted and outlives the call.
+		*/
+		struct ParallelRecording
+		{
+			std::uint32_t m_num_chunks = 0;
+			std::atomic<std::uint32_t> m_next_chunk = 0;
+			std::atomic<std::uint32_t> m_finished_chunks = 0;
+			std::function<void(std::uint32_t)> m_record;
+		};
+
+		/*! Where a task is in a `TaskDispatch`. */
+		enum class DispatchState : std::uint8_t
+		{
+			NOT_DISPATCHED, //!< Not part of the dispatch. Counts as finished.
+			PENDING, //!< Waiting for its dependencies.
+			READY, //!< Handed to the thread pool or the dispatching thread and not started yet.
+			RUNNING,
+			FINISHED
+		};
+
+		/*! State of a single `FrameGraph::Dispatch_MT_Impl` call. */
+		/*!
+			Every task counts its unfinished dependencies. A finishing task decrements the counters of its successors
+			and hands the successors that reached zero to the thread pool, or to the dispatching thread when they aren't allowed to multithread.
+			Tasks on the thread pool still hold a reference, so the state is reference counted and outlives the call.
+		*/
+		struct TaskDispatch
+		{
+			explicit TaskDispatch(std::uint32_t num_tasks) :
+				m_num_tasks(num_tasks),
+				m_states(new std::atomic<DispatchState>[num_tasks]),
+				m_num_pending(new std::atomic<std::uint32_t>[num_tasks]),
+				m_main_thread_only(num_tasks, false),
+				m_dependencies(num_tasks),
+				m_successors(num_tasks)
+			{
+				for (std::uint32_t i = 0; i < num_tasks; ++i)
+				{
+					m_states[i].store(DispatchState::NOT_DISPATCHED, std::memory_order_relaxed);
+					m_num_pending[i].store(0, std::memory_order_relaxed);
+				}
+			}
+
+			std::uint32_t m_num_tasks;
+			std::unique_ptr<std::atomic<DispatchState>[]> m_states;
+			/*! The number of unfinished dependencies of a task. */
+			std::unique_ptr<std::atomic<std::uint32_t>[]> m_num_pending;
+			std::vector<bool> m_main_thread_only;
+			/*! The dispatched dependencies and successors of the dispatched tasks. */
+			std::vector<std::vector<std::uint32_t>> m_dependencies;
+			std::vector<std::vector<std::uint32_t>> m_successors;
+			std::function<void(std::uint32_t)> m_func;
+			/*! Incremented whenever a task becomes ready, starts or finishes. Waiting threads sleep on it. */
+			std::atomic<std::uint32_t> m_progress = 0;
+
+			/*! Tasks that have to run on the dispatching thread and are ready. */
+			std::mutex m_main_thread_mutex;
+			std::condition_variable m_main_thread_condition;
+			std::vector<std::uint32_t> m_main_thread_tasks;
+			/*! Only touched by the dispatching thread. */
+			std::uint32_t m_num_unfinished_main_thread_tasks = 0;
+		};
+	} /* internal */
+
 	// Forward declarations.
 	class FrameGraph;
+	struct CameraNode;
 
 	/*! Structure that describes a render task */
 	/*!
@@ -78,6 +191,7 @@ namespace wr
 		using setup_func_t =   util::Delegate<void(RenderSystem&, FrameGraph&, RenderTaskHandle, bool)>;
 		using execute_func_t = util::Delegate<void(RenderSystem&, FrameGraph&, SceneGraph&, RenderTaskHandle)>;
 		using destroy_func_t = util::Delegate<void(FrameGraph&, RenderTaskHandle, bool)>;
+		using fingerprint_func_t = util::Delegate<std::uint64_t(RenderSystem&, FrameGraph&, SceneGraph&, RenderTaskHandle)>;
 
 		/*! The type of the render task.*/
 		RenderTaskType m_type = RenderTaskType::DIRECT;
@@ -85,11 +199,39 @@ namespace wr
 		setup_func_t m_setup_func;
 		execute_func_t m_execute_func;
 		destroy_func_t m_destroy_func;
+		/*! Optional function that returns a fingerprint of everything the output of the task depends on. */
+		/*!
+			Called every frame before the tasks execute. When the fingerprint equals the one of the last time the task executed,
+			the task is skipped and the output it recorded last time is reused. Skipped tasks don't keep their dependencies from being culled.
+			Include the settings, input texture handles and scene state the task reads. Use `util::HashCombine` to combine them.
+			A task that couldn't finish its work can call `FrameGraph::InvalidateFingerprint` to execute again next frame.
+		*/
+		fingerprint_func_t m_fingerprint_func;
 
 		/*! The properties for the render target this task renders to. If this is `std::nullopt` no render target will be created. */
 		std::optional<RenderTargetProperties> m_properties;
 
 		bool m_allow_multithreading = true;
+		/*! The number of command lists the task can record into in parallel with `FrameGraph::RecordParallel`. */
+		/*!
+			The lists are executed after the command list of the task, in order, before the render target is transitioned back.
+			Only use this for tasks with a lot of independent draw calls, every list has a fixed cost to record and submit.
+		*/
+		std::uint32_t m_num_secondary_cmd_lists = 0;
+		/*! Whether the render target is only used during the frame. */
+		/*!
+			Transient render targets are included in the aliasing plan of the frame graph.
+			Only enable this if every task that reads the render target declares this task with `FG_DEPS`
+			and the content of the render target isn't needed in the next frame.
+		*/
+		bool m_transient = false;
+		/*! Whether the task has state that depends on the output resolution. */
+		/*!
+			`FrameGraph::Resize` skips tasks that are resolution independent.
+			Their destroy and setup functions aren't called and their render target keeps its size.
+			Only disable this if the task doesn't use its render target size and doesn't keep descriptors to render targets of other tasks.
+		*/
+		bool m_resolution_dependent = true;
 	};
 
 	//!  Frame Graph 
@@ -106,6 +248,7 @@ namespace wr
 		using setup_func_t   = RenderTaskDesc::setup_func_t;
 		using execute_func_t = RenderTaskDesc::execute_func_t;
 		using destroy_func_t = RenderTaskDesc::destroy_func_t;
+		using fingerprint_func_t = RenderTaskDesc::fingerprint_func_t;
 	public:
 
 		//! Constructor.
@@ -128,17 +271,26 @@ namespace wr
 			reserve(m_execute_funcs);
 			reserve(m_destroy_funcs);
 			reserve(m_cmd_lists);
+			reserve(m_num_secondary_cmd_lists);
 			reserve(m_render_targets);
 			reserve(m_data);
+			reserve(m_data_factories);
 			reserve(m_data_type_info);
-#ifndef FG_MAX_PERFORMANCE
+			reserve(m_type_indices);
+			reserve(m_views);
 			reserve(m_dependencies);
+			reserve(m_setup_lookups);
+			reserve(m_is_setup);
+#ifndef FG_MAX_PERFORMANCE
 			reserve(m_names);
 #endif
 			reserve(m_types);
+			reserve(m_fingerprint_funcs);
+			reserve(m_fingerprints);
+			reserve(m_new_fingerprints);
+			reserve(m_memoized);
 			reserve(m_rt_properties);
-			m_settings = decltype(m_settings)(num_reserved_tasks, std::nullopt); // Resizing so I can initialize it with null since this is an optional value.
-			m_futures.resize(num_reserved_tasks); // std::thread doesn't allow me to reserve memory for the vector. Hence I'm resizing.
+			m_settings.resize(num_reserved_tasks); // Resizing so I can initialize it with null since the settings are created by `UpdateSettings`.
 		}
 
 		//! Destructor
@@ -148,6 +300,12 @@ namespace wr
 		*/
 		~FrameGraph()
 		{
+			if constexpr (settings::save_thread_pool_stats)
+			{
+				const auto name = "frame_graph_" + std::to_string(m_uid);
+				util::SaveThreadPoolStats(m_thread_pool->GetStats(), name, name + "_thread_pool_stats.json");
+			}
+
 			delete m_thread_pool;
 			Destroy();
 		}
@@ -162,6 +320,8 @@ namespace wr
 		/*!
 			Calls all setup function pointers and obtains the required render targets and command lists.
 			It is recommended to try to avoid calling this during runtime because it can cause stalls if the setup functions are expensive.
+			Tasks that are already set up are skipped, so after changing a live frame graph with `AddTask`, `RemoveTask` or `ReplaceTask`
+			only the new tasks and the tasks that were torn down by the change are set up again.
 			\param render_system The render system we want to use for rendering.
 		*/
 		inline void Setup(RenderSystem& render_system)
@@ -174,13 +334,26 @@ namespace wr
 				return;
 			}
 
-			// Resize these vectors since we know the end size already.
+			CompileDependencies();
+#ifdef FG_ENABLE_PROFILING
+			m_profiler.SetDependencies(m_dependency_handles);
+#endif
+
+			// Resize these vectors since we know the end size already. Tasks that are already set up keep their entries.
 			m_cmd_lists.resize(m_num_tasks);
+			m_secondary_cmd_lists.resize(m_num_tasks);
+			m_closing_cmd_lists.resize(m_num_tasks);
+			m_num_recorded_secondary_cmd_lists.resize(m_num_tasks, 0);
 			m_should_execute.resize(m_num_tasks, true); // All tasks should execute by default.
+			m_enabled.resize(m_num_tasks, true);
 			m_render_targets.resize(m_num_tasks);
-			m_futures.resize(m_num_tasks);
+			m_resource_usages.resize(m_num_tasks);
+			m_resource_initial_states.resize(m_num_tasks);
 			m_render_system = &render_system;
 
+			// Make the settings published before setup visible to the setup functions.
+			AcquireSettings();
+
 			auto get_command_list_from_render_system = [this](auto type)
 			{
 				switch (type)
@@ -201,12 +374,27 @@ namespace wr
 			{
 				for (decltype(m_num_tasks) i = 0; i < m_num_tasks; ++i)
 				{
+					if (m_is_setup[i])
+					{
+						continue;
+					}
+
 					// Get the proper command list from the render system.
 					m_cmd_lists[i] = get_command_list_from_render_system(m_types[i]);
 #ifndef FG_MAX_PERFORMANCE
 					render_system.SetCommandListName(m_cmd_lists[i], m_names[i]);
 #endif
 
+					// Get the command lists the task records into in parallel and the one that finishes the task after them.
+					for (std::uint32_t j = 0; j < m_num_secondary_cmd_lists[i]; ++j)
+					{
+						m_secondary_cmd_lists[i].push_back(get_command_list_from_render_system(m_types[i]));
+					}
+					if (m_num_secondary_cmd_lists[i] > 0)
+					{
+						m_closing_cmd_lists[i] = get_command_list_from_render_system(m_types[i]);
+					}
+
 					// Get a render target from the render system.
 					if (m_rt_properties[i].has_value())
 					{
@@ -224,12 +412,27 @@ namespace wr
 				// Itterate over all the tasks.
 				for (decltype(m_num_tasks) i = 0; i < m_num_tasks; ++i)
 				{
+					if (m_is_setup[i])
+					{
+						continue;
+					}
+
 					// Get the proper command list from the render system.
 					m_cmd_lists[i] = get_command_list_from_render_system(m_types[i]);
 #ifndef FG_MAX_PERFORMANCE
 					render_system.SetCommandListName(m_cmd_lists[i], m_names[i]);
 #endif
 
+					// Get the command lists the task records into in parallel and the one that finishes the task after them.
+					for (std::uint32_t j = 0; j < m_num_secondary_cmd_lists[i]; ++j)
+					{
+						m_secondary_cmd_lists[i].push_back(get_command_list_from_render_system(m_types[i]));
+					}
+					if (m_num_secondary_cmd_lists[i] > 0)
+					{
+						m_closing_cmd_lists[i] = get_command_list_from_render_system(m_types[i]);
+					}
+
 					// Get a render target from the render system.
 					if (m_rt_properties[i].has_value())
 					{
@@ -240,34 +443,80 @@ namespace wr
 					}
 
 					// Call the setup function pointer.
-					m_setup_funcs[i](render_system, *this, i, false);
+					CallSetupFunction(i, false);
 				}
 			}
 
-			// Finish the setup before continuing for savety.
-			for (decltype(m_num_tasks) i = 0; i < m_num_tasks; ++i)
-			{
-				WaitForCompletion(i);
-			}
+			m_is_setup.assign(m_num_tasks, true);
+			m_has_pending_changes = false;
+
+			m_aliasing_plan.reset();
+			UpdateCulling();
+			UpdateResourceBarrierPlan();
+			UpdateQueueSubmissionPlan();
 		}
 
 		/*! Execute all render tasks */
 		/*!
 			For every render task call the setup function pointers and tell the render system we started a render task of a certain type.
+			Tasks added or torn down since the last `Setup` are set up first. If that fails validation no task executes this frame.
 			\param render_system The render system we want to use for rendering.
 			\param scene_graph The scene graph we want to render.
 		*/
 		inline void Execute(SceneGraph& scene_graph)
 		{
+#ifdef FG_ENABLE_PROFILING
+			m_profiler.BeginFrame();
+#endif
+
 			ResetOutputTexture();
 
+			// Set up the tasks that were added or torn down since the last `Setup`.
+			if (m_has_pending_changes)
+			{
+				Setup(*m_render_system);
+
+				// A failed setup leaves tasks that were never set up. Don't record anything until the frame graph is valid again.
+				if (m_has_pending_changes)
+				{
+					m_should_execute.assign(m_num_tasks, false);
+					m_submission_plan = {};
+					return;
+				}
+			}
+
+			// Pick up the settings published since the last frame. They don't change while the tasks execute.
+			AcquireSettings();
+
 			// Check if we need to disable some tasks
+			bool enabled_changed = m_outputs_changed;
 			while (!m_should_execute_change_request.empty())
 			{
 				auto front = m_should_execute_change_request.front();
-				m_should_execute[front.first] = front.second;
+				enabled_changed |= m_enabled[front.first] != front.second;
+				m_enabled[front.first] = front.second;
 				m_should_execute_change_request.pop();
 			}
+			m_outputs_changed = false;
+
+			// Skip the tasks whose inputs didn't change since they last executed.
+			enabled_changed |= UpdateFingerprints(scene_graph);
+
+			// Disabling a task can cull its producers. The barriers depend on which tasks execute.
+			if (enabled_changed && UpdateCulling())
+			{
+				UpdateResourceBarrierPlan();
+				UpdateQueueSubmissionPlan();
+			}
+
+			// Only remember the fingerprints of tasks that actually execute. Culled tasks have to execute when they come back.
+			for (decltype(m_num_tasks) i = 0; i < m_num_tasks; ++i)
+			{
+				if (m_should_execute[i] && m_fingerprint_funcs[i])
+				{
+					m_fingerprints[i] = m_new_fingerprints[i];
+				}
+			}
 
 			if constexpr (settings::use_multithreading)
 			{
@@ -284,6 +533,8 @@ namespace wr
 			This function calls resize all render tasks to a specific width and height.
 			The width and height parameters should be the output size.
 			Please note this function calls Destroy than setup with the resize boolean set to true.
+			Tasks that are not resolution dependent (`RenderTaskDesc::m_resolution_dependent`) or that aren't set up yet are skipped.
+			Like in `Setup` the render targets are resized on the calling thread first, after that the tasks are destroyed and set up again in dependency order.
 		*/
 		inline void Resize(std::uint32_t width, std::uint32_t height)
 		{
@@ -298,17 +549,29 @@ namespace wr
 
 			for (decltype(m_num_tasks) i = 0; i < m_num_tasks; ++i)
 			{
-				m_destroy_funcs[i](*this, i, true);
-
-				if (m_rt_properties[i].has_value() && !m_rt_properties[i].value().m_is_render_window)
+				if (m_resolution_dependent[i] && m_is_setup[i])
 				{
-					m_render_system->ResizeRenderTarget(&m_render_targets[i],
-						static_cast<std::uint32_t>(std::ceil(width * m_rt_properties[i].value().m_resolution_scale.Get())),
-						static_cast<std::uint32_t>(std::ceil(height * m_rt_properties[i].value().m_resolution_scale.Get())));
+					ResizeTaskRenderTarget(i, width, height);
 				}
+			}
 
-				m_setup_funcs[i](*m_render_system, *this, i, true);
+			if constexpr (settings::use_multithreading)
+			{
+				Resize_MT_Impl();
+			}
+			else
+			{
+				for (decltype(m_num_tasks) i = 0; i < m_num_tasks; ++i)
+				{
+					if (m_resolution_dependent[i] && m_is_setup[i])
+					{
+						ResetResizedTask(i);
+					}
+				}
 			}
+
+			m_aliasing_plan.reset();
+			UpdateResourceBarrierPlan();
 		}
 
 		/*! Get Resolution scale of specified Render Task */
@@ -340,12 +603,19 @@ namespace wr
 				WaitForCompletion(i);
 			}
 
-			m_render_system->WaitForAllPreviousWork();
+			// A frame graph that was never set up doesn't have a render system.
+			if (m_render_system)
+			{
+				m_render_system->WaitForAllPreviousWork();
+			}
 
-			// Send the destroy events to the render tasks.
+			// Send the destroy events to the render tasks. Tasks that were torn down by a change to the frame graph are already destroyed.
 			for (decltype(m_num_tasks) i = 0; i < m_num_tasks; ++i)
 			{
-				m_destroy_funcs[i](*this, i, false);
+				if (m_is_setup[i])
+				{
+					m_destroy_funcs[i](*this, i, false);
+				}
 			}
 
 			// Make sure we free the data objects we allocated.
@@ -354,14 +624,15 @@ namespace wr
 				data.reset();
 			}
 
-			for (auto& cmd_list : m_cmd_lists)
+			// Tasks that were never set up don't have command lists.
+			for (decltype(m_num_tasks) i = 0; i < m_cmd_lists.size(); ++i)
 			{
-				m_render_system->DestroyCommandList(cmd_list);
+				DestroyCommandLists(i);
 			}
 
 			for(decltype(m_num_tasks) i = 0; i < m_num_tasks; ++i)
 			{
-				if(m_rt_properties[i].has_value() && !m_rt_properties[i]->m_is_render_window)
+				if(m_is_setup[i] && m_rt_properties[i].has_value() && !m_rt_properties[i]->m_is_render_window)
 				{
 					m_render_system->DestroyRenderTarget(&m_render_targets[i]);
 				}
@@ -372,37 +643,134 @@ namespace wr
 			m_execute_funcs.clear();
 			m_destroy_funcs.clear();
 			m_cmd_lists.clear();
+			m_secondary_cmd_lists.clear();
+			m_closing_cmd_lists.clear();
+			m_num_recorded_secondary_cmd_lists.clear();
+			m_num_secondary_cmd_lists.clear();
 			m_render_targets.clear();
 			m_data.clear();
+			m_data_factories.clear();
 			m_data_type_info.clear();
+			m_type_indices.clear();
+			m_handles_by_type.clear();
+			m_views.clear();
+			m_view_handles_by_type.clear();
+			m_view_cameras.clear();
 			m_settings.clear();
-#ifndef FG_MAX_PERFORMANCE
+			m_should_execute.clear();
+			m_enabled.clear();
+			m_is_output.clear();
 			m_dependencies.clear();
+			m_dependency_handles.clear();
+			m_setup_lookups.clear();
+			m_is_setup.clear();
+			m_insert_position = std::nullopt;
+			m_has_pending_changes = false;
+			m_allow_multithreading.clear();
+			m_fingerprint_funcs.clear();
+			m_fingerprints.clear();
+			m_new_fingerprints.clear();
+			m_memoized.clear();
+			m_transient.clear();
+			m_resolution_dependent.clear();
+			m_aliasing_plan.reset();
+			m_resource_usages.clear();
+			m_resource_initial_states.clear();
+			m_barriers_before.clear();
+			m_barriers_after.clear();
+			m_submission_plan = {};
+			m_group_leaders.clear();
+			m_group_tasks.clear();
+			m_group_dependencies.clear();
+#ifndef FG_MAX_PERFORMANCE
 			m_names.clear();
+#endif
+#ifdef FG_ENABLE_PROFILING
+			m_profiler.RemoveTasks();
 #endif
 			m_types.clear();
 			m_rt_properties.clear();
-			m_futures.clear();
+			m_dispatch.reset();
 
 			m_num_tasks = 0;
 		}
 
 		/* Stall the current thread until the render task has finished. */
+		/*!
+			A task that waits for a task that didn't start yet runs it, or one of its ready dependencies, on its own thread.
+			Tasks only wait for earlier tasks, so every worker waiting for a predecessor keeps the frame graph moving.
+		*/
 		inline void WaitForCompletion(RenderTaskHandle handle)
 		{
 			// If we are not allowed to use multithreading let the compiler optimize this away completely.
 			if constexpr (settings::use_multithreading)
 			{
-				if (auto& future = m_futures[handle]; future.valid())
+				// Tasks that share a command list are recorded together. Earlier tasks of the group this thread records are already recorded.
+				const auto leader = GetGroupLeader(handle);
+				if (m_recording_group.first == this && m_recording_group.second == leader)
+				{
+					return;
+				}
+
+				// Keep the dispatch alive, tasks running on this thread can start the next one.
+				const auto dispatch = m_dispatch;
+				if (!dispatch || IsDispatchFinished(*dispatch, leader))
+				{
+					return;
+				}
+
+#ifdef FG_ENABLE_PROFILING
+				// Only record waits that actually stalled the thread.
+				const auto begin = FrameGraphProfiler::clock_t::now();
+#endif
+
+				auto& state = dispatch->m_states[leader];
+				while (!IsDispatchFinished(*dispatch, leader))
 				{
-					future.wait();
+					// Read before looking for work, so progress made in between wakes this thread up again.
+					const auto progress = dispatch->m_progress.load(std::memory_order_acquire);
+
+					// Only threads running a task of the dispatch help, other threads would delay their own work.
+					if (m_running_dispatch == dispatch.get() && RunReadyDependency(dispatch, leader))
+					{
+						continue;
+					}
+
+					if (auto current = state.load(std::memory_order_acquire); current == internal::DispatchState::RUNNING || m_running_dispatch != dispatch.get())
+					{
+						// Woken up when the task starts or finishes.
+						state.wait(current, std::memory_order_acquire);
+					}
+					else
+					{
+						// The task waits for dependencies that run on other threads. One of them becoming ready can give this thread work.
+						dispatch->m_progress.wait(progress, std::memory_order_acquire);
+					}
 				}
+
+#ifdef FG_ENABLE_PROFILING
+				m_profiler.Record(FrameGraphProfiler::EventType::WAIT, FrameGraphProfiler::GetCurrentTask(), begin, FrameGraphProfiler::clock_t::now(), handle);
+#endif
+			}
+		}
+
+		/*! Check whether a task finished recording without waiting for it. */
+		inline bool IsRecorded(RenderTaskHandle handle)
+		{
+			if constexpr (settings::use_multithreading)
+			{
+				auto dispatch = m_dispatch.get();
+				return !dispatch || IsDispatchFinished(*dispatch, GetGroupLeader(handle));
+			}
+			else
+			{
+				return true;
 			}
 		}
 
 		/*! Wait for a previous task. */
 		/*!
-			This function loops over all tasks and checks whether it has the same type information as the template variable.
+			This function looks up the task with the same data type as the template variable.
 			If a task was found it waits for it.
 			If no task is found with the type specified a nullptr will be returned and a error message send to the logging system.
 			The template parameter should be a Data struct of a the task you want to wait for.
@@ -417,13 +785,10 @@ namespace wr
 			static_assert(!std::is_pointer<T>::value,
 				"The template variable type should not be a pointer. Its implicitly converted to a pointer.");
 
-			for (decltype(m_num_tasks) i = 0; i < m_num_tasks; i++)
+			if (auto handle = GetHandleFromType<T>(); handle.has_value())
 			{
-				if (typeid(T) == m_data_type_info[i])
-				{
-					WaitForCompletion(i);
-					return;
-				}
+				WaitForCompletion(handle.value());
+				return;
 			}
 
 			LOGC("Failed to find predecessor data! Please check your task order.");
@@ -464,14 +829,11 @@ namespace wr
 			static_assert(!std::is_pointer<T>::value,
 				"The template variable type should not be a pointer. Its implicitly converted to a pointer.");
 
-			for (decltype(m_num_tasks) i = 0; i < m_num_tasks; i++)
+			if (auto handle = GetHandleFromType<T>(); handle.has_value())
 			{
-				if (typeid(T) == m_data_type_info[i])
-				{
-					WaitForCompletion(i);
+				WaitForCompletion(handle.value());
 
-					return *static_cast<T*>(m_data[i].get());
-				}
+				return *static_cast<T*>(m_data[handle.value()].get());
 			}
 
 			LOGC("Failed to find predecessor data! Please check your task order.")
@@ -491,14 +853,11 @@ namespace wr
 			static_assert(!std::is_pointer<T>::value,
 				"The template variable type should not be a pointer. Its implicitly converted to a pointer.");
 
-			for (decltype(m_num_tasks) i = 0; i < m_num_tasks; i++)
+			if (auto handle = GetHandleFromType<T>(); handle.has_value())
 			{
-				if (typeid(T) == m_data_type_info[i])
-				{
-					WaitForCompletion(i);
+				WaitForCompletion(handle.value());
 
-					return m_render_targets[i];
-				}
+				return m_render_targets[handle.value()];
 			}
 
 			LOGC("Failed to find predecessor render target! Please check your task order.");
@@ -508,6 +867,7 @@ namespace wr
 		/*! Get the command list of a task. */
 		/*!
 			The template variable allows you to cast the command list to a "non platform independent" different type. For example a `D3D12CommandList`.
+			Tasks merged by command list coalescing (see `SetCommandListCoalescing`) return the command list of the first task of their group.
 			\param handle The handle to the render task. (Given by the `Setup`, `Execute` and `Destroy` functions)
 		*/
 		template<typename T = CommandList>
@@ -518,7 +878,86 @@ namespace wr
 			static_assert(!std::is_pointer<T>::value,
 				"The template variable type should not be a pointer. Its implicitly converted to a pointer.");
 
-			return static_cast<T*>(m_cmd_lists[handle]);
+			return static_cast<T*>(m_cmd_lists[GetGroupLeader(handle)]);
+		}
+
+		/*! Record a part of a task in parallel. */
+		/*!
+			Splits `num_items` into one chunk per secondary command list (`RenderTaskDesc::m_num_secondary_cmd_lists`)
+			and calls `func(cmd_list, first_item, num_items)` for every chunk. The chunks are recorded on the thread pool and by the calling thread.
+			The render target of the task is bound to the secondary command lists, but other state like the pipeline, viewport and root arguments isn't inherited.
+			The secondary command lists are executed in order after everything recorded into the command list of the task,
+			so call this at the end of the execute function. Can be called once per frame.
+			Returns when all chunks are recorded.
+			\param handle The handle of the task that is executing.
+			\param num_items The number of items to split over the command lists, for example the number of batches.
+			\param func The function that records a chunk. Has to be safe to call from multiple threads.
+		*/
+		template<typename F>
+		inline void RecordParallel(RenderTaskHandle handle, std::size_t num_items, F func)
+		{
+			if (m_secondary_cmd_lists[handle].empty())
+			{
+				LOGW("Task has no secondary command lists. The chunks are recorded in the command list of the task.");
+				func(GetCommandList(handle), std::size_t(0), num_items);
+				return;
+			}
+
+			if (m_num_recorded_secondary_cmd_lists[handle] != 0)
+			{
+				LOGW("`RecordParallel` can only be called once per frame. Ignored the call.");
+				return;
+			}
+
+			const auto num_chunks = static_cast<std::uint32_t>(std::min<std::size_t>(m_secondary_cmd_lists[handle].size(), num_items));
+			if (num_chunks == 0)
+			{
+				return;
+			}
+
+			auto recording = std::make_shared<internal::ParallelRecording>();
+			recording->m_num_chunks = num_chunks;
+			recording->m_record = [this, handle, num_items, num_chunks, func](std::uint32_t chunk)
+			{
+				auto cmd_list = m_secondary_cmd_lists[handle][chunk];
+				const auto first_item = num_items * chunk / num_chunks;
+				const auto last_item = num_items * (chunk + 1ull) / num_chunks;
+
+				m_render_system->ResetCommandList(cmd_list);
+				if (m_types[handle] == RenderTaskType::DIRECT && m_rt_properties[handle].has_value())
+				{
+					m_render_system->ContinueRenderTask(cmd_list, { m_render_targets[handle], m_rt_properties[handle].value() });
+				}
+
+				func(cmd_list, first_item, last_item - first_item);
+
+				m_render_system->CloseCommandList(cmd_list);
+			};
+			m_num_recorded_secondary_cmd_lists[handle] = num_chunks;
+
+			if constexpr (settings::use_multithreading)
+			{
+				// The calling thread records as well, so this doesn't wait for a thread pool that is busy with other tasks.
+				for (std::uint32_t i = 1; i < num_chunks; ++i)
+				{
+					m_thread_pool->Enqueue([recording]
+					{
+						RecordChunks(*recording);
+					});
+				}
+
+				RecordChunks(*recording);
+
+				// Only wait for the chunks other threads are recording right now. The last chunk wakes this thread up.
+				for (auto finished = recording->m_finished_chunks.load(std::memory_order_acquire); finished < num_chunks; finished = recording->m_finished_chunks.load(std::memory_order_acquire))
+				{
+					recording->m_finished_chunks.wait(finished, std::memory_order_acquire);
+				}
+			}
+			else
+			{
+				RecordChunks(*recording);
+			}
 		}
 
 		/*! Get the command list of a previously ran task. */
@@ -535,14 +974,11 @@ namespace wr
 			static_assert(!std::is_pointer<T>::value,
 				"The template variable type should not be a pointer. Its implicitly converted to a pointer.");
 
-			for (decltype(m_num_tasks) i = 0; i < m_num_tasks; i++)
+			if (auto handle = GetHandleFromType<T>(); handle.has_value())
 			{
-				if (typeid(T) == m_data_type_info[i])
-				{
-					WaitForCompletion(i);
+				WaitForCompletion(handle.value());
 
-					return m_cmd_lists[i];
-				}
+				return GetCommandList(handle.value());
 			}
 
 			LOGC("Failed to find predecessor command list! Please check your task order.");
@@ -565,67 +1001,183 @@ namespace wr
 				}
 
 				WaitForCompletion(i);
-				retval.push_back(static_cast<T*>(m_cmd_lists[i]));
+				AppendCommandLists(retval, i);
 			}
 
 			return retval;
 		}
 
-		/*! Get the render target of a task. */
+		/*! Hand the command lists to `submit` in batches as the tasks finish recording. */
 		/*!
-			The template variable allows you to cast the render target to a "non platform independent" different type. For example a `D3D12RenderTarget`.
-			\param handle The handle to the render task. (Given by the `Setup`, `Execute` and `Destroy` functions)
+			Walks the executed tasks in execution order and waits for every batch of `min_tasks_per_batch` tasks.
+			Tasks after a batch that already finished recording are added to it, so the batches get larger when recording is ahead.
+			This lets the GPU start on the first tasks while later tasks are still recording.
+			The batches are submitted in execution order, so this ignores the compute queue of `GetQueueSubmissionPlan`.
+			With profiling enabled every batch is recorded as a `FrameGraphProfiler::EventType::SUBMIT` event.
+			\param min_tasks_per_batch The minimum number of tasks in a batch. The last batch can be smaller.
+			\param submit Called on the calling thread with a `std::vector<T*>` holding the command lists of a batch.
 		*/
-		template<typename T = RenderTarget>
-		[[nodiscard]] inline auto GetRenderTarget(RenderTaskHandle handle) const
+		template<typename T, typename F>
+		inline void StreamCommandLists(std::uint32_t min_tasks_per_batch, F submit)
 		{
-			static_assert(std::is_class<T>::value || std::is_void<T>::value,
-				"The template variable should be a void, class or struct.");
-			static_assert(!std::is_pointer<T>::value,
-				"The template variable type should not be a pointer. Its implicitly converted to a pointer.");
+			std::vector<T*> batch;
+			std::uint32_t num_batch_tasks = 0;
+			RenderTaskHandle first_batch_task = 0;
+			RenderTaskHandle last_batch_task = 0;
 
-			return static_cast<T*>(m_render_targets[handle]);
+			auto submit_batch = [&]()
+			{
+				// Tasks merged into the command list of a task in an earlier batch don't add command lists.
+				if (!batch.empty())
+				{
+#ifdef FG_ENABLE_PROFILING
+					const auto begin = FrameGraphProfiler::clock_t::now();
+#endif
+					submit(batch);
+#ifdef FG_ENABLE_PROFILING
+					m_profiler.Record(FrameGraphProfiler::EventType::SUBMIT, first_batch_task, begin, FrameGraphProfiler::clock_t::now(), last_batch_task);
+#endif
+				}
+
+				batch.clear();
+				num_batch_tasks = 0;
+			};
+
+			for (decltype(m_num_tasks) i = 0; i < m_num_tasks; ++i)
+			{
+				if (!m_should_execute[i])
+				{
+					continue;
+				}
+
+				// Don't hold back a full batch for a task that is still recording.
+				if (num_batch_tasks >= min_tasks_per_batch && !IsRecorded(i))
+				{
+					submit_batch();
+				}
+
+				WaitForCompletion(i);
+				AppendCommandLists(batch, i);
+
+				if (num_batch_tasks == 0)
+				{
+					first_batch_task = i;
+				}
+				last_batch_task = i;
+				num_batch_tasks++;
+			}
+
+			submit_batch();
 		}
 
-		/*! Check if this frame graph has a task. */
+		/*! Get the command lists of a queue submission. */
 		/*!
-			This checks if the frame graph has the task that has been given as the template variable.
+			Waits for the tasks in the submission to finish recording.
+			\param submission A submission from `GetQueueSubmissionPlan`.
 		*/
 		template<typename T>
-		inline bool HasTask() const
+		[[nodiscard]] std::vector<T*> GetCommandLists(QueueSubmission const & submission)
 		{
-			return GetHandleFromType<T>().has_value();
+			std::vector<T*> retval;
+			retval.reserve(submission.m_tasks.size());
+
+			for (const auto handle : submission.m_tasks)
+			{
+				WaitForCompletion(handle);
+				AppendCommandLists(retval, handle);
+			}
+
+			return retval;
 		}
 
-		/*! Validates the frame graph for correctness */
+		/*! Return how the executed tasks are submitted to the direct and compute queue. */
 		/*!
-			This function uses the dependencies to check whether the frame graph is constructed properly by the user.
-			Note: This function only works when `FG_MAX_PERFORMANCE` is defined.
+			The tasks in the submissions are task handles.
+			Without `settings::use_async_compute` all tasks are in a single direct submission.
 		*/
-		bool Validate()
+		[[nodiscard]] QueueSubmissionPlan const & GetQueueSubmissionPlan() const noexcept
 		{
-			bool result = true;
-#ifndef FG_MAX_PERFORMANCE
+			return m_submission_plan;
+		}
 
-			// Loop over all the tasks.
-			for (decltype(m_num_tasks) handle = 0; handle < m_num_tasks; ++handle)
+		/*! Set how many consecutive tasks are recorded into a single command list. */
+		/*!
+			Consecutive tasks of the same type in the same queue submission are merged, unless they record secondary command lists (see `RecordParallel`).
+			Only the command list of the first task in a group is returned by `GetCommandLists` and `GetAllCommandLists`.
+			Call this between frames. The default policy uses `settings::max_coalesced_tasks`.
+		*/
+		inline void SetCommandListCoalescing(CommandListCoalescingPolicy const & policy)
+		{
+			m_coalescing_policy = policy;
+
+			if (m_render_system)
 			{
-				// Loop over the task's dependencies.
-				for (auto dependency : m_dependencies[handle])
+				for (decltype(m_num_tasks) i = 0; i < m_num_tasks; ++i)
 				{
-					bool found_dependency = false;
-
-					// Loop over the predecessor tasks.
-					for (decltype(m_num_tasks) prev_handle = 0; prev_handle < handle; ++prev_handle)
-					{
-						const auto& task_type_info = m_data_type_info[prev_handle].get();
-						if (task_type_info == dependency.get())
-						{
-							found_dependency = true;
-						}
-					}
+					WaitForCompletion(i);
+				}
+
+				UpdateCommandListGroups();
+			}
+		}
+
+		/*! Return the queue depth, worker utilization and task latency of the thread pool that executes the tasks. */
+		[[nodiscard]] util::ThreadPoolStats GetThreadPoolStats() const
+		{
+			return m_thread_pool->GetStats();
+		}
+
+#ifdef FG_ENABLE_PROFILING
+		/*! Return the profiler containing the setup, execute and wait timings of the tasks. */
+		[[nodiscard]] FrameGraphProfiler const & GetProfiler() const noexcept
+		{
+			return m_profiler;
+		}
+#endif
+
+		/*! Get the render target of a task. */
+		/*!
+			The template variable allows you to cast the render target to a "non platform independent" different type. For example a `D3D12RenderTarget`.
+			\param handle The handle to the render task. (Given by the `Setup`, `Execute` and `Destroy` functions)
+		*/
+		template<typename T = RenderTarget>
+		[[nodiscard]] inline auto GetRenderTarget(RenderTaskHandle handle) const
+		{
+			static_assert(std::is_class<T>::value || std::is_void<T>::value,
+				"The template variable should be a void, class or struct.");
+			static_assert(!std::is_pointer<T>::value,
+				"The template variable type should not be a pointer. Its implicitly converted to a pointer.");
+
+			return static_cast<T*>(m_render_targets[handle]);
+		}
 
-					if (!found_dependency)
+		/*! Check if this frame graph has a task. */
+		/*!
+			This checks if the frame graph has the task that has been given as the template variable.
+		*/
+		template<typename T>
+		inline bool HasTask() const
+		{
+			return GetHandleFromType<T>().has_value();
+		}
+
+		/*! Validates the frame graph for correctness */
+		/*!
+			This function uses the dependencies to check whether the frame graph is constructed properly by the user.
+			Note: This function only works when `FG_MAX_PERFORMANCE` is defined.
+		*/
+		bool Validate()
+		{
+			bool result = true;
+#ifndef FG_MAX_PERFORMANCE
+
+			// Loop over all the tasks.
+			for (decltype(m_num_tasks) handle = 0; handle < m_num_tasks; ++handle)
+			{
+				// Loop over the task's dependencies.
+				for (auto dependency : m_dependencies[handle])
+				{
+					if (!FindDependency(handle, dependency.get()).has_value())
 					{
 						LOGW("Framegraph validation: Failed to find dependency {}", dependency.get().name());
 						result = false;
@@ -641,48 +1193,217 @@ namespace wr
 		/*!
 			This creates a new render task based on a description.
 			The dependencies parameters can contain a list of typeid's of render tasks this task depends on.
+			The frame graph won't dispatch the task before its dependencies have finished.
 			You can use the FG_DEPS macro as followed: `AddTask<desc, FG_DEPS(OtherTaskData)>`
+			The task is added at the end of the frame graph, or at the position set with `SetInsertPosition`.
+			When the frame graph is already set up, the tasks that looked up a task of type `T` during their setup are torn down.
+			The new task and the torn down tasks are set up by the next `Setup` or `Execute`.
 			\param desc A description of the render task.
 		*/
 		template<typename T>
 		inline void AddTask(RenderTaskDesc& desc, std::wstring const & name, std::vector<std::reference_wrapper<const std::type_info>> dependencies = {})
 		{
-			static_assert(std::is_class<T>::value ||
-				std::is_floating_point<T>::value ||
-				std::is_integral<T>::value,
-				"The template variable should be a class, struct, floating point value or a integral value.");
-			static_assert(std::is_default_constructible<T>::value,
-				"The template variable is not default constructible or nothrow consructible!");
-			static_assert(!std::is_pointer<T>::value,
-				"The template variable type should not be a pointer. Its implicitly converted to a pointer.");
+			InsertTask<T>(m_insert_position.value_or(m_num_tasks), desc, name, dependencies);
+		}
 
-			m_setup_funcs.emplace_back(desc.m_setup_func);
-			m_execute_funcs.emplace_back(desc.m_execute_func);
-			m_destroy_funcs.emplace_back(desc.m_destroy_func);
-#ifndef FG_MAX_PERFORMANCE
-			m_dependencies.emplace_back(dependencies);
-			m_names.emplace_back(name);
-#endif
-			m_settings.resize(m_num_tasks + 1ull);
-			m_types.emplace_back(desc.m_type);
-			m_rt_properties.emplace_back(desc.m_properties);
-			m_data.emplace_back(std::make_shared<T>());
-			m_data_type_info.emplace_back(typeid(T));
+		/*! Replace a task of a live frame graph. */
+		/*!
+			Removes the task with data type `T` and adds the new description at the same position.
+			The task and the tasks that depend on it are torn down and set up again by the next `Setup` or `Execute`.
+			Unrelated tasks keep their command lists, render targets and data.
+		*/
+		template<typename T>
+		inline void ReplaceTask(RenderTaskDesc& desc, std::wstring const & name, std::vector<std::reference_wrapper<const std::type_info>> dependencies = {})
+		{
+			auto handle = GetHandleFromType<T>();
 
-			// If we are allowed to do multithreading place the task in the appropriate vector
-			if constexpr (settings::use_multithreading)
+			if (!handle.has_value())
 			{
-				if (desc.m_allow_multithreading)
-				{
-					m_multi_threaded_tasks.emplace_back(m_num_tasks);
-				}
-				else
+				LOGW("Failed to replace the task, Task was not found.");
+				return;
+			}
+
+			EraseTask(handle.value());
+			InsertTask<T>(handle.value(), desc, name, dependencies);
+		}
+
+		/*! Remove a task from the frame graph. */
+		/*!
+			The tasks that look the task up during their setup are torn down and set up again by the next `Setup` or `Execute`.
+			A task that other tasks name with `FG_DEPS` can't be removed, those tasks have to be removed first. Use `ReplaceTask` to swap it out.
+			Tasks after the removed task move one handle down.
+		*/
+		inline void RemoveTask(RenderTaskHandle handle)
+		{
+			if (handle >= m_num_tasks)
+			{
+				LOGW("Failed to remove the task, The handle is out of range.");
+				return;
+			}
+
+			for (auto dependent = handle + 1; dependent < m_num_tasks; ++dependent)
+			{
+				for (auto dependency : m_dependencies[dependent])
 				{
-					m_single_threaded_tasks.emplace_back(m_num_tasks);
+					if (FindDependency(dependent, dependency.get()) == handle)
+					{
+						LOGW("Failed to remove the task, Task {} depends on it.", dependent);
+						return;
+					}
 				}
 			}
 
-			m_num_tasks++;
+			EraseTask(handle);
+		}
+
+		/*! Remove a task from the frame graph. Templated version */
+		template<typename T>
+		inline void RemoveTask()
+		{
+			auto handle = GetHandleFromType<T>();
+
+			if (handle.has_value())
+			{
+				RemoveTask(handle.value());
+			}
+			else
+			{
+				LOGW("Failed to remove the task, Task was not found.");
+			}
+		}
+
+		/*! Set where `AddTask` inserts new tasks. */
+		/*!
+			Tasks are inserted before the task at `handle` and the position moves along, so consecutive calls keep their order.
+			This allows the existing `Add...Task` functions to insert tasks in the middle of a live frame graph.
+			\param handle The handle of the task to insert before. `std::nullopt` appends tasks at the end again.
+		*/
+		inline void SetInsertPosition(std::optional<RenderTaskHandle> handle)
+		{
+			if (handle.has_value() && handle.value() > m_num_tasks)
+			{
+				LOGW("Insert position is out of range. Tasks will be added at the end.");
+				handle = std::nullopt;
+			}
+
+			m_insert_position = handle;
+		}
+
+		/*! Set where `AddTask` inserts new tasks. Templated version that inserts before the task with data type `T`. */
+		template<typename T>
+		inline void SetInsertPosition()
+		{
+			auto handle = GetHandleFromType<T>();
+
+			if (!handle.has_value())
+			{
+				LOGW("Failed to set the insert position, Task was not found.");
+			}
+
+			SetInsertPosition(handle);
+		}
+
+		/*! Make `AddTask` append new tasks at the end of the frame graph again. */
+		inline void ResetInsertPosition()
+		{
+			m_insert_position = std::nullopt;
+		}
+
+		/*! Add the tasks of a view. */
+		/*!
+			Instantiates a frame graph description for one of several views of the same scene graph, like a picture-in-picture camera.
+			Tasks added by `func` belong to `view`. Lookups by data type inside `func` and inside the tasks of the view resolve to the task of the same view,
+			or to a task added outside of `ForView`. Those shared tasks, like an acceleration structure build, run once for all views.
+			`FG_DEPS` resolves the same way, so the task chains of different views don't depend on each other and are recorded concurrently on the thread pool.
+			Outside of `ForView` lookups return the shared task, or the task of the first view that has one.
+			\param view The index of the view.
+			\param func Called with this frame graph. E.g. `[](FrameGraph& fg) { tasks::AddDeferredMainTask(fg, std::nullopt, std::nullopt); }`
+		*/
+		template<typename F>
+		inline void ForView(std::uint32_t view, F func)
+		{
+			const auto previous_view = m_current_view;
+			m_current_view = { this, view };
+
+			func(*this);
+
+			m_current_view = previous_view;
+		}
+
+		/*! Set the camera a view renders with. */
+		/*!
+			The camera should be part of the scene graph the frame graph renders, so its constant buffer is updated every frame.
+		*/
+		inline void SetViewCamera(std::uint32_t view, std::shared_ptr<CameraNode> camera)
+		{
+			if (view >= m_view_cameras.size())
+			{
+				m_view_cameras.resize(view + 1ull);
+			}
+
+			m_view_cameras[view] = std::move(camera);
+		}
+
+		/*! Get the camera of the view a task belongs to.
+			Tasks fall back to the active camera of the scene graph when this returns `nullptr`.
+			\return The camera set with `SetViewCamera`, or `nullptr` for shared tasks and views without a camera.
+		*/
+		[[nodiscard]] inline std::shared_ptr<CameraNode> GetViewCamera(RenderTaskHandle handle) const
+		{
+			if (const auto view = m_views[handle]; view.has_value() && view.value() < m_view_cameras.size())
+			{
+				return m_view_cameras[view.value()];
+			}
+
+			return nullptr;
+		}
+
+		/*! Get the view a task belongs to. `std::nullopt` for shared tasks. */
+		[[nodiscard]] inline std::optional<std::uint32_t> GetView(RenderTaskHandle handle) const
+		{
+			return m_views[handle];
+		}
+
+		/*! Declare that a task accesses a resource. */
+		/*!
+			Call this from the setup function of the task.
+			The frame graph calculates the transitions between the tasks and records them before and after the execute function,
+			so the task doesn't have to transition the resource itself.
+			Don't declare the render target of the task itself. That one is transitioned using the render target properties.
+			\param handle The handle of the task that accesses the resource.
+			\param resource The native resource. For D3D12 this is a `ID3D12Resource*`.
+			\param state The state the resource has to be in while the task executes.
+		*/
+		inline void DeclareResourceUsage(RenderTaskHandle handle, void* resource, ResourceState state)
+		{
+			m_resource_usages[handle].push_back({ handle, reinterpret_cast<std::uintptr_t>(resource), static_cast<std::uint32_t>(state) });
+		}
+
+		/*! Declare the state a resource is in outside of the frame graph. */
+		/*!
+			The frame graph expects the resource in this state at the start of the frame and transitions it back at the end.
+			Without an initial state the state of the first task that uses the resource is assumed.
+			Call this from the setup function of the task.
+		*/
+		inline void DeclareResourceInitialState(RenderTaskHandle handle, void* resource, ResourceState state)
+		{
+			m_resource_initial_states[handle].push_back({ reinterpret_cast<std::uintptr_t>(resource), static_cast<std::uint32_t>(state) });
+		}
+
+		/*! Return the aliasing plan of the transient render targets. */
+		/*!
+			The plan describes how the render targets of tasks marked as `m_transient` can share a single heap.
+			No backend allocates from it yet, so it's only calculated when requested and kept until the next `Setup`, `Resize` or task change.
+			Returns an empty plan before `Setup`. Call it from the thread that owns the frame graph.
+		*/
+		[[nodiscard]] RenderTargetAliasingPlan const & GetRenderTargetAliasingPlan() const
+		{
+			if (!m_aliasing_plan.has_value())
+			{
+				m_aliasing_plan = m_render_system ? PlanRenderTargetAliasing(GetTransientRenderTargetLifetimes()) : RenderTargetAliasingPlan();
+			}
+
+			return m_aliasing_plan.value();
 		}
 
 		/*! Return the frame graph's unique id.*/
@@ -769,24 +1490,95 @@ namespace wr
 			}
 		}
 
+		/*! Forget the input fingerprint of a task. */
+		/*!
+			The task executes during the next frame even if its fingerprint didn't change.
+			Safe to call from the execute function of the task itself.
+		*/
+		inline void InvalidateFingerprint(RenderTaskHandle handle)
+		{
+			m_fingerprints[handle] = std::nullopt;
+		}
 
-		/*! Update the settings of a task. */
+		/*! Forget the input fingerprint of a task. Templated version */
+		template<typename T>
+		inline void InvalidateFingerprint()
+		{
+			auto handle = GetHandleFromType<T>();
+
+			if (handle.has_value())
+			{
+				InvalidateFingerprint(handle.value());
+			}
+			else
+			{
+				LOGW("Failed to invalidate the fingerprint, Task was not found.");
+			}
+		}
+
+		/*! Mark a task as output of the frame graph. */
 		/*!
-			This is used to update settings of a render task.
-			This must ge called BEFORE `FrameGraph::Setup` or `RenderSystem::Render`.
+			When at least one task is marked as output, tasks that no enabled output depends on are culled.
+			This is recalculated every time a task gets enabled or disabled with `SetShouldExecute`.
+			Only dependencies declared with `FG_DEPS` are followed, so every task that feeds an output has to declare its dependencies.
+			Tasks with side effects outside of the frame graph (like uploads or acceleration structure builds) should be marked as output as well.
 		*/
+		inline void SetOutputTask(RenderTaskHandle handle, bool value = true)
+		{
+			m_is_output[handle] = value;
+			m_outputs_changed = true;
+		}
+
+		/*! Mark a task as output of the frame graph. Templated version */
 		template<typename T>
-		inline void UpdateSettings(std::any settings)
+		inline void SetOutputTask(bool value = true)
 		{
 			auto handle = GetHandleFromType<T>();
 
 			if (handle.has_value())
 			{
-				m_settings[handle.value()] = settings;
+				SetOutputTask(handle.value(), value);
 			}
 			else
+			{
+				LOGW("Failed to mark the task as output, Task was not found.");
+			}
+		}
+
+
+		/*! Update the settings of a task. */
+		/*!
+			This is used to update settings of a render task.
+			The first call for a task creates its settings and must be called BEFORE `FrameGraph::Setup`, usually right after `AddTask`.
+			After that the settings can be updated from any thread while the frame graph is executing, as long as only one thread updates them at a time.
+			The new settings are used from the next `FrameGraph::Execute`. Updating doesn't lock or allocate.
+			\tparam T The render task data type used for identification.
+			\tparam S The type of the settings object. Has to be the same type every time.
+		*/
+		template<typename T, typename S>
+		inline void UpdateSettings(S const & settings)
+		{
+			auto handle = GetHandleFromType<T>();
+
+			if (!handle.has_value())
 			{
 				LOGW("Failed to update settings, Could not find render task");
+				return;
+			}
+
+			auto& task_settings = m_settings[handle.value()];
+
+			if (!task_settings)
+			{
+				task_settings = std::make_unique<TaskSettings<S>>(settings);
+			}
+			else if (task_settings->GetTypeIndex() == internal::GetTaskSettingsTypeIndex<S>())
+			{
+				static_cast<TaskSettings<S>*>(task_settings.get())->Publish(settings);
+			}
+			else
+			{
+				LOGW("Failed to update settings, The settings type doesn't match the type the task was created with.");
 			}
 		}
 
@@ -800,28 +1592,21 @@ namespace wr
 
 		*/
 		template<typename T, typename R>
-		[[nodiscard]] inline R GetSettings() const try
+		[[nodiscard]] inline R GetSettings() const
 		{
 			static_assert(std::is_class<T>::value ||
 				std::is_floating_point<T>::value ||
 				std::is_integral<T>::value,
 				"The first template variable should be a class, struct, floating point value or a integral value.");
 
-			for (decltype(m_num_tasks) i = 0; i < m_num_tasks; i++)
+			if (auto handle = GetHandleFromType<T>(); handle.has_value())
 			{
-				if (typeid(T) == m_data_type_info[i])
-				{
-					return std::any_cast<R>(m_settings[i].value());
-				}
+				return GetSettings<R>(handle.value());
 			}
 
 			LOGC("Failed to find task settings! Does your frame graph contain this task?");
 			return R();
 		}
-		catch (const std::bad_any_cast & e) {
-			LOGC("A task settings requested failed to cast to T. ({})", e.what());
-			return R();
-		}
 
 		/*! Gives you the settings of a task by handle. */
 		/*!
@@ -830,18 +1615,34 @@ namespace wr
 			The return value can be a nullptr.
 		*/
 		template<typename T>
-		[[nodiscard]] inline T GetSettings(RenderTaskHandle handle) const try
+		[[nodiscard]] inline T GetSettings(RenderTaskHandle handle) const
 		{
 			static_assert(std::is_class<T>::value ||
 				std::is_floating_point<T>::value ||
 				std::is_integral<T>::value,
 				"The template variable should be a class, struct, floating point value or a integral value.");
 
-			return std::any_cast<T>(m_settings[handle].value());
+			auto const & task_settings = m_settings[handle];
+
+			if (!task_settings || task_settings->GetTypeIndex() != internal::GetTaskSettingsTypeIndex<T>())
+			{
+				LOGW("A task settings requested failed to cast to T.");
+				return T();
+			}
+
+			return static_cast<TaskSettings<T> const *>(task_settings.get())->Get();
 		}
-		catch (const std::bad_any_cast& e) {
-			LOGW("A task settings requested failed to cast to T. ({})", e.what());
-			return T();
+
+		/*! Make the latest published settings of every task the current settings. */
+		inline void AcquireSettings()
+		{
+			for (auto& task_settings : m_settings)
+			{
+				if (task_settings)
+				{
+					task_settings->Acquire();
+				}
+			}
 		}
 
 		/*! Resets the CPU texture data for this frame. */
@@ -855,94 +1656,1138 @@ namespace wr
 	private:
 
 		/*! Get the handle from a task by data type */
-		/* This function is zero overhead with GCC-8.2, -03 */
+		/*!
+			Uses the type index of `T` to look the handle up in constant time.
+			If multiple tasks use the same data type the first one added is returned.
+			Inside a view (see `ForView`) the task of that view is preferred over a shared task.
+			Lookups made by a setup function are remembered, so the task can be set up again when a task of type `T` is added, removed or replaced.
+		*/
 		template<typename T>
 		inline std::optional<RenderTaskHandle> GetHandleFromType() const
 		{
-			for (decltype(m_num_tasks) i = 0; i < m_num_tasks; ++i)
+			const auto type_index = internal::GetFrameGraphTypeIndex<T>();
+
+			if (m_task_in_setup.first == this)
 			{
-				if (m_data_type_info[i].get() == typeid(T))
+				auto& lookups = m_setup_lookups[m_task_in_setup.second];
+				if (std::find(lookups.begin(), lookups.end(), type_index) == lookups.end())
 				{
-					return i;
+					lookups.push_back(type_index);
 				}
 			}
 
-			return std::nullopt;
-		}
+			if (type_index >= m_handles_by_type.size())
+			{
+				return std::nullopt;
+			}
 
-		/*! Setup tasks multi threaded */
-		inline void Setup_MT_Impl()
-		{
-			// Multithreading behaviour
-			for (const auto handle : m_multi_threaded_tasks)
+			if (auto view = GetCurrentView(); view.has_value())
 			{
-				m_futures[handle] = m_thread_pool->Enqueue([this, handle]
+				auto& view_handles = m_view_handles_by_type[type_index];
+				if (view.value() < view_handles.size() && view_handles[view.value()].has_value())
 				{
-					m_setup_funcs[handle](*m_render_system, *this, handle, false);
-				});
+					return view_handles[view.value()];
+				}
+
+				// Tasks of other views are never returned inside a view.
+				const auto handle = m_handles_by_type[type_index];
+				if (handle.has_value() && m_views[handle.value()].has_value())
+				{
+					return std::nullopt;
+				}
 			}
 
-			// Singlethreading behaviour
-			for (const auto handle : m_single_threaded_tasks)
+			return m_handles_by_type[type_index];
+		}
+
+		/*! Get the view that tasks are added to and looked up in on this thread. */
+		inline std::optional<std::uint32_t> GetCurrentView() const
+		{
+			if (m_current_view.first == this)
 			{
-				m_setup_funcs[handle](*m_render_system, *this, handle, false);
+				return m_current_view.second;
 			}
+
+			return std::nullopt;
 		}
 
-		/*! Execute tasks multi threaded */
-		inline void Execute_MT_Impl(SceneGraph& scene_graph)
+		/*! Find the task a dependency of a task resolves to. */
+		/*!
+			A task of a view depends on the first earlier task of the same view, or the first shared task if the view doesn't have one.
+			Shared tasks only depend on shared tasks.
+		*/
+		inline std::optional<RenderTaskHandle> FindDependency(RenderTaskHandle handle, std::type_info const & dependency) const
 		{
-			// Multithreading behaviour
-			for (const auto handle : m_multi_threaded_tasks)
+			std::optional<RenderTaskHandle> shared_dependency;
+
+			for (decltype(m_num_tasks) prev_handle = 0; prev_handle < handle; ++prev_handle)
 			{
-				// Skip this task if it doesn't need to be executed
-				if (!m_should_execute[handle])
+				if (m_data_type_info[prev_handle].get() != dependency)
 				{
 					continue;
 				}
 
-				m_futures[handle] = m_thread_pool->Enqueue([this, handle, &scene_graph]
+				if (m_views[prev_handle] == m_views[handle])
 				{
-					ExecuteSingleTask(scene_graph, handle);
-				});
+					return prev_handle;
+				}
+				if (!m_views[prev_handle].has_value() && !shared_dependency.has_value())
+				{
+					shared_dependency = prev_handle;
+				}
+			}
+
+			return shared_dependency;
+		}
+
+		/*! Remove a task without checking the tasks that depend on it. Used by `RemoveTask` and `ReplaceTask`. */
+		inline void EraseTask(RenderTaskHandle handle)
+		{
+			TearDownDependentTasks(handle, m_type_indices[handle]);
+
+			auto erase = [handle](auto& v)
+			{
+				// Vectors that are only filled by `Setup` can be smaller than the number of tasks.
+				if (handle < v.size())
+				{
+					v.erase(v.begin() + handle);
+				}
+			};
+
+			erase(m_setup_funcs);
+			erase(m_execute_funcs);
+			erase(m_destroy_funcs);
+			erase(m_dependencies);
+#ifndef FG_MAX_PERFORMANCE
+			erase(m_names);
+#endif
+#ifdef FG_ENABLE_PROFILING
+			m_profiler.RemoveTask(handle);
+#endif
+			erase(m_settings);
+			erase(m_types);
+			erase(m_rt_properties);
+			erase(m_data);
+			erase(m_data_factories);
+			erase(m_data_type_info);
+			erase(m_type_indices);
+			erase(m_views);
+			erase(m_allow_multithreading);
+			erase(m_fingerprint_funcs);
+			erase(m_fingerprints);
+			erase(m_new_fingerprints);
+			erase(m_memoized);
+			erase(m_transient);
+			m_aliasing_plan.reset();
+			erase(m_resolution_dependent);
+			erase(m_is_output);
+			erase(m_setup_lookups);
+			erase(m_is_setup);
+			erase(m_cmd_lists);
+			erase(m_secondary_cmd_lists);
+			erase(m_closing_cmd_lists);
+			erase(m_num_recorded_secondary_cmd_lists);
+			erase(m_num_secondary_cmd_lists);
+			erase(m_render_targets);
+			erase(m_should_execute);
+			erase(m_enabled);
+			erase(m_resource_usages);
+			erase(m_resource_initial_states);
+			erase(m_barriers_before);
+			erase(m_barriers_after);
+
+			m_num_tasks--;
+
+			if (m_insert_position.has_value() && m_insert_position.value() > handle)
+			{
+				m_insert_position = m_insert_position.value() - 1;
+			}
+
+			OnTasksMoved(handle, false);
+		}
+
+		/*! Insert a task at a position in the frame graph. */
+		/*!
+			Used by `AddTask` and `ReplaceTask`. Tasks at and after `position` move one handle up.
+		*/
+		template<typename T>
+		inline void InsertTask(RenderTaskHandle position, RenderTaskDesc& desc, std::wstring const & name, std::vector<std::reference_wrapper<const std::type_info>> dependencies)
+		{
+			static_assert(std::is_class<T>::value ||
+				std::is_floating_point<T>::value ||
+				std::is_integral<T>::value,
+				"The template variable should be a class, struct, floating point value or a integral value.");
+			static_assert(std::is_default_constructible<T>::value,
+				"The template variable is not default constructible or nothrow consructible!");
+			static_assert(!std::is_pointer<T>::value,
+				"The template variable type should not be a pointer. Its implicitly converted to a pointer.");
+
+			const auto type_index = internal::GetFrameGraphTypeIndex<T>();
+
+			// Tasks that looked up a task of this type during their setup have to see the new task.
+			TearDownDependentTasks(std::nullopt, type_index);
+
+			auto insert = [position](auto& v, auto value)
+			{
+				// Vectors that are only filled by `Setup` can be smaller than the number of tasks.
+				if (position <= v.size())
+				{
+					v.insert(v.begin() + position, std::move(value));
+				}
+			};
+
+			m_setup_funcs.insert(m_setup_funcs.begin() + position, desc.m_setup_func);
+			m_execute_funcs.insert(m_execute_funcs.begin() + position, desc.m_execute_func);
+			m_destroy_funcs.insert(m_destroy_funcs.begin() + position, desc.m_destroy_func);
+			m_dependencies.insert(m_dependencies.begin() + position, dependencies);
+#ifndef FG_MAX_PERFORMANCE
+			m_names.insert(m_names.begin() + position, name);
+#endif
+#ifdef FG_ENABLE_PROFILING
+			m_profiler.InsertTask(position, name);
+#endif
+			m_settings.resize(m_num_tasks);
+			m_settings.insert(m_settings.begin() + position, nullptr);
+			m_types.insert(m_types.begin() + position, desc.m_type);
+			m_rt_properties.insert(m_rt_properties.begin() + position, desc.m_properties);
+			m_data.insert(m_data.begin() + position, MakeTaskData<T>());
+			m_data_factories.insert(m_data_factories.begin() + position, &MakeTaskData<T>);
+			m_data_type_info.insert(m_data_type_info.begin() + position, typeid(T));
+			m_type_indices.insert(m_type_indices.begin() + position, type_index);
+			m_views.insert(m_views.begin() + position, GetCurrentView());
+			m_allow_multithreading.insert(m_allow_multithreading.begin() + position, desc.m_allow_multithreading);
+			m_num_secondary_cmd_lists.insert(m_num_secondary_cmd_lists.begin() + position, desc.m_num_secondary_cmd_lists);
+			m_fingerprint_funcs.insert(m_fingerprint_funcs.begin() + position, desc.m_fingerprint_func);
+			m_fingerprints.insert(m_fingerprints.begin() + position, std::nullopt);
+			m_new_fingerprints.insert(m_new_fingerprints.begin() + position, 0);
+			m_memoized.insert(m_memoized.begin() + position, false);
+			m_transient.insert(m_transient.begin() + position, desc.m_transient);
+			m_aliasing_plan.reset();
+			m_resolution_dependent.insert(m_resolution_dependent.begin() + position, desc.m_resolution_dependent);
+			m_is_output.insert(m_is_output.begin() + position, false);
+			m_setup_lookups.insert(m_setup_lookups.begin() + position, std::vector<std::uint32_t>());
+			m_is_setup.insert(m_is_setup.begin() + position, false);
+
+			insert(m_cmd_lists, static_cast<CommandList*>(nullptr));
+			insert(m_secondary_cmd_lists, std::vector<CommandList*>());
+			insert(m_closing_cmd_lists, static_cast<CommandList*>(nullptr));
+			insert(m_num_recorded_secondary_cmd_lists, 0u);
+			insert(m_render_targets, static_cast<RenderTarget*>(nullptr));
+			insert(m_should_execute, true);
+			insert(m_enabled, true);
+			insert(m_resource_usages, std::vector<ResourceUsage>());
+			insert(m_resource_initial_states, std::vector<ResourceInitialState>());
+			insert(m_barriers_before, std::vector<ResourceBarrier>());
+			insert(m_barriers_after, std::vector<ResourceBarrier>());
+
+			m_num_tasks++;
+
+			if (m_insert_position.has_value() && m_insert_position.value() >= position)
+			{
+				m_insert_position = m_insert_position.value() + 1;
+			}
+
+			OnTasksMoved(position, true);
+		}
+
+		/*! Update the handle based lookups after a task was inserted or removed. */
+		/*!
+			\param position The handle of the inserted or removed task.
+			\param inserted True if a task was inserted at `position`, false if it was removed.
+		*/
+		inline void OnTasksMoved(RenderTaskHandle position, bool inserted)
+		{
+			m_handles_by_type.clear();
+			m_view_handles_by_type.clear();
+
+			// Shared tasks are found first, so lookups outside of a view prefer them.
+			// A task that only exists in views can still be found, it resolves to the first one added.
+			for (bool shared : { true, false })
+			{
+				for (decltype(m_num_tasks) handle = 0; handle < m_num_tasks; ++handle)
+				{
+					if (m_views[handle].has_value() == shared)
+					{
+						continue;
+					}
+
+					const auto type_index = m_type_indices[handle];
+					if (type_index >= m_handles_by_type.size())
+					{
+						m_handles_by_type.resize(type_index + 1ull, std::nullopt);
+						m_view_handles_by_type.resize(type_index + 1ull);
+					}
+					if (!m_handles_by_type[type_index].has_value())
+					{
+						m_handles_by_type[type_index] = handle;
+					}
+
+					if (!shared)
+					{
+						auto& view_handles = m_view_handles_by_type[type_index];
+						const auto view = m_views[handle].value();
+						if (view >= view_handles.size())
+						{
+							view_handles.resize(view + 1ull, std::nullopt);
+						}
+						if (!view_handles[view].has_value())
+						{
+							view_handles[view] = handle;
+						}
+					}
+				}
+			}
+
+			CompileDependencies();
+#ifdef FG_ENABLE_PROFILING
+			m_profiler.SetDependencies(m_dependency_handles);
+#endif
+
+			// Every task records into its own command list until the next setup plans the groups again.
+			m_group_leaders.clear();
+			m_group_tasks.clear();
+			m_group_dependencies.clear();
+
+			// Move the queued requests along with their tasks. Requests for a removed task are dropped.
+			std::queue<std::pair<RenderTaskHandle, bool>> requests;
+			while (!m_should_execute_change_request.empty())
+			{
+				auto request = m_should_execute_change_request.front();
+				m_should_execute_change_request.pop();
+
+				if (request.first >= position)
+				{
+					if (inserted)
+					{
+						request.first++;
+					}
+					else if (request.first == position)
+					{
+						continue;
+					}
+					else
+					{
+						request.first--;
+					}
+				}
+
+				requests.push(request);
+			}
+			m_should_execute_change_request = std::move(requests);
+
+			// The outputs and the plans have to be recalculated. `Execute` does this when it sets up the pending tasks.
+			m_outputs_changed = true;
+			if (m_render_system)
+			{
+				m_has_pending_changes = true;
+			}
+		}
+
+		/*! Tear down the tasks that depend on a changed task. */
+		/*!
+			A task depends on the changed task if it declared it with `FG_DEPS` or looked up its type during setup.
+			This is followed transitively, so a task reading from a torn down task is torn down as well.
+			Tasks that access another task without declaring or looking it up are not torn down.
+			\param changed_task The handle of the changed task, or `std::nullopt` if a task of `changed_type_index` is about to be added.
+			\param changed_type_index The type index of the changed task. See `internal::GetFrameGraphTypeIndex`.
+		*/
+		inline void TearDownDependentTasks(std::optional<RenderTaskHandle> changed_task, std::uint32_t changed_type_index)
+		{
+			if (std::find(m_is_setup.begin(), m_is_setup.end(), true) == m_is_setup.end())
+			{
+				return;
+			}
+
+			// The tasks can't be destroyed while the GPU or the thread pool are still using them.
+			for (decltype(m_num_tasks) i = 0; i < m_num_tasks; ++i)
+			{
+				WaitForCompletion(i);
+			}
+			m_render_system->WaitForAllPreviousWork();
+
+			std::vector<bool> affected_tasks(m_num_tasks, false);
+			std::vector<bool> affected_types(std::max<std::size_t>(m_handles_by_type.size(), changed_type_index + 1ull), false);
+			affected_types[changed_type_index] = true;
+
+			// Dependencies always point to earlier tasks, so a single pass in handle order is enough.
+			for (decltype(m_num_tasks) handle = 0; handle < m_num_tasks; ++handle)
+			{
+				bool affected = changed_task.has_value() && changed_task.value() == handle;
+
+				for (const auto dependency : m_dependency_handles[handle])
+				{
+					affected |= affected_tasks[dependency];
+				}
+
+				for (const auto type_index : m_setup_lookups[handle])
+				{
+					affected |= type_index < affected_types.size() && affected_types[type_index];
+				}
+
+				if (!affected)
+				{
+					continue;
+				}
+
+				affected_tasks[handle] = true;
+				if (m_type_indices[handle] >= affected_types.size())
+				{
+					affected_types.resize(m_type_indices[handle] + 1ull, false);
+				}
+				affected_types[m_type_indices[handle]] = true;
+
+				if (m_is_setup[handle])
+				{
+					TearDownTask(handle);
+				}
+			}
+		}
+
+		/*! Destroy a task and reset its data so it can be set up again. */
+		inline void TearDownTask(RenderTaskHandle handle)
+		{
+			m_destroy_funcs[handle](*this, handle, false);
+
+			DestroyCommandLists(handle);
+
+			if (m_render_targets[handle] && m_rt_properties[handle].has_value() && !m_rt_properties[handle]->m_is_render_window)
+			{
+				m_render_system->DestroyRenderTarget(&m_render_targets[handle]);
+			}
+			m_render_targets[handle] = nullptr;
+
+			m_data[handle] = m_data_factories[handle]();
+			m_resource_usages[handle].clear();
+			m_resource_initial_states[handle].clear();
+			m_setup_lookups[handle].clear();
+			m_fingerprints[handle] = std::nullopt;
+			m_is_setup[handle] = false;
+		}
+
+		/*! Create the data of a task. Stored per task so torn down tasks can start with fresh data. */
+		template<typename T>
+		static std::shared_ptr<void> MakeTaskData()
+		{
+			return std::make_shared<T>();
+		}
+
+		/*! Resolve the dependencies of all tasks to task handles. */
+		/*!
+			Turns the type information passed with `FG_DEPS` into a dependency graph of task handles.
+			A task can only depend on tasks that were added before it. So the order the tasks were added in is a valid topological order.
+			Tasks of a view resolve their dependencies within the view. See `FindDependency`.
+			Dependencies that can't be found are ignored here. `Validate` reports them.
+		*/
+		inline void CompileDependencies()
+		{
+			m_dependency_handles.clear();
+			m_dependency_handles.resize(m_num_tasks);
+
+			for (decltype(m_num_tasks) handle = 0; handle < m_num_tasks; ++handle)
+			{
+				for (auto dependency : m_dependencies[handle])
+				{
+					if (auto prev_handle = FindDependency(handle, dependency.get()); prev_handle.has_value())
+					{
+						m_dependency_handles[handle].push_back(prev_handle.value());
+					}
+				}
+			}
+		}
+
+		/*! Calculate when the transient render targets are used. */
+		/*!
+			A render target is first used by the task that owns it.
+			Its last use is the last task that declared the owner as a dependency.
+			Tasks are executed in the order they were added so the task handle is the execution index.
+		*/
+		inline std::vector<RenderTargetLifetime> GetTransientRenderTargetLifetimes() const
+		{
+			std::vector<RenderTargetLifetime> lifetimes;
+			std::vector<std::optional<std::size_t>> lifetime_indices(m_num_tasks, std::nullopt);
+
+			for (decltype(m_num_tasks) handle = 0; handle < m_num_tasks; ++handle)
+			{
+				if (!m_transient[handle] || !m_rt_properties[handle].has_value() || m_rt_properties[handle]->m_is_render_window.Get())
+				{
+					continue;
+				}
+
+				auto allocation_info = m_render_system->GetRenderTargetAllocationInfo(m_rt_properties[handle].value());
+
+				RenderTargetLifetime lifetime;
+				lifetime.m_handle = handle;
+				lifetime.m_size_in_bytes = allocation_info.m_size_in_bytes;
+				lifetime.m_alignment = allocation_info.m_alignment;
+				lifetime.m_first_use = handle;
+				lifetime.m_last_use = handle;
+
+				lifetime_indices[handle] = lifetimes.size();
+				lifetimes.push_back(lifetime);
+			}
+
+			for (decltype(m_num_tasks) handle = 0; handle < m_num_tasks; ++handle)
+			{
+				for (const auto dependency : m_dependency_handles[handle])
+				{
+					if (auto idx = lifetime_indices[dependency]; idx.has_value())
+					{
+						auto& lifetime = lifetimes[idx.value()];
+						lifetime.m_last_use = std::max(lifetime.m_last_use, handle);
+					}
+				}
+			}
+
+			return lifetimes;
+		}
+
+		/*! Call the fingerprint functions and decide which tasks can reuse their previous output. */
+		/*!
+			A task is skipped when its fingerprint equals the one of the last time it executed.
+			\return Whether a task started or stopped being skipped.
+		*/
+		inline bool UpdateFingerprints(SceneGraph& scene_graph)
+		{
+			bool changed = false;
+
+			for (decltype(m_num_tasks) handle = 0; handle < m_num_tasks; ++handle)
+			{
+				if (!m_fingerprint_funcs[handle] || !m_enabled[handle])
+				{
+					continue;
+				}
+
+				m_new_fingerprints[handle] = m_fingerprint_funcs[handle](*m_render_system, *this, scene_graph, handle);
+
+				const bool memoized = m_fingerprints[handle].has_value() && m_fingerprints[handle].value() == m_new_fingerprints[handle];
+				changed |= m_memoized[handle] != memoized;
+				m_memoized[handle] = memoized;
+			}
+
+			return changed;
+		}
+
+		/*! Recalculate which tasks execute. */
+		/*!
+			A task executes when it is enabled, isn't skipped by its fingerprint and, if any outputs are marked,
+			it can reach an enabled output through enabled tasks that aren't skipped.
+			\return Whether the set of executed tasks changed.
+		*/
+		inline bool UpdateCulling()
+		{
+			std::vector<bool> reachable(m_num_tasks, false);
+			std::vector<RenderTaskHandle> to_visit;
+			bool has_outputs = false;
+
+			for (decltype(m_num_tasks) handle = 0; handle < m_num_tasks; ++handle)
+			{
+				if (!m_is_output[handle])
+				{
+					continue;
+				}
+
+				has_outputs = true;
+				if (m_enabled[handle] && !m_memoized[handle])
+				{
+					reachable[handle] = true;
+					to_visit.push_back(handle);
+				}
+			}
+
+			// Without outputs nothing gets culled.
+			if (!has_outputs)
+			{
+				reachable.assign(m_num_tasks, true);
+			}
+
+			// Walk the dependencies backwards. A disabled or skipped task doesn't consume its dependencies.
+			while (!to_visit.empty())
+			{
+				const auto handle = to_visit.back();
+				to_visit.pop_back();
+
+				for (const auto dependency : m_dependency_handles[handle])
+				{
+					if (!reachable[dependency] && m_enabled[dependency] && !m_memoized[dependency])
+					{
+						reachable[dependency] = true;
+						to_visit.push_back(dependency);
+					}
+				}
+			}
+
+			bool changed = false;
+			for (decltype(m_num_tasks) handle = 0; handle < m_num_tasks; ++handle)
+			{
+				const bool should_execute = m_enabled[handle] && !m_memoized[handle] && reachable[handle];
+				changed |= m_should_execute[handle] != should_execute;
+				m_should_execute[handle] = should_execute;
+			}
+
+			return changed;
+		}
+
+		/*! Recalculate the resource barriers of the tasks that execute. */
+		inline void UpdateResourceBarrierPlan()
+		{
+			std::vector<ResourceUsage> usages;
+			std::vector<ResourceInitialState> initial_states;
+			std::vector<RenderTaskHandle> executed_tasks;
+			std::vector<SubmissionQueue> queues;
+			executed_tasks.reserve(m_num_tasks);
+
+			// The planner works with execution indices so disabled tasks don't split barriers.
+			for (decltype(m_num_tasks) handle = 0; handle < m_num_tasks; ++handle)
+			{
+				initial_states.insert(initial_states.end(), m_resource_initial_states[handle].begin(), m_resource_initial_states[handle].end());
+
+				if (!m_should_execute[handle])
+				{
+					continue;
+				}
+
+				queues.push_back(GetSubmissionQueue(handle));
+
+				const auto execution_idx = static_cast<std::uint32_t>(executed_tasks.size());
+				for (auto usage : m_resource_usages[handle])
+				{
+					usage.m_task = execution_idx;
+					usages.push_back(usage);
+				}
+
+				executed_tasks.push_back(handle);
+			}
+
+			auto plan = PlanResourceBarriers(static_cast<std::uint32_t>(executed_tasks.size()), usages, initial_states, internal::read_only_resource_states, queues);
+
+			m_barriers_before.assign(m_num_tasks, {});
+			m_barriers_after.assign(m_num_tasks, {});
+			for (std::size_t i = 0; i < executed_tasks.size(); ++i)
+			{
+				m_barriers_before[executed_tasks[i]] = std::move(plan.m_before[i]);
+				m_barriers_after[executed_tasks[i]] = std::move(plan.m_after[i]);
+			}
+		}
+
+		/*! The queue a task is submitted to. */
+		inline SubmissionQueue GetSubmissionQueue(RenderTaskHandle handle) const
+		{
+			if constexpr (settings::use_async_compute)
+			{
+				if (m_types[handle] == RenderTaskType::COMPUTE)
+				{
+					return SubmissionQueue::COMPUTE;
+				}
+			}
+
+			return SubmissionQueue::DIRECT;
+		}
+
+		/*! Recalculate how the tasks that execute are split over the direct and compute queue. */
+		inline void UpdateQueueSubmissionPlan()
+		{
+			std::vector<std::optional<std::uint32_t>> execution_indices(m_num_tasks, std::nullopt);
+			std::vector<RenderTaskHandle> executed_tasks;
+			std::vector<SubmissionQueue> queues;
+			std::vector<std::vector<std::uint32_t>> dependencies;
+
+			for (decltype(m_num_tasks) handle = 0; handle < m_num_tasks; ++handle)
+			{
+				if (!m_should_execute[handle])
+				{
+					continue;
+				}
+
+				std::vector<std::uint32_t> task_dependencies;
+				for (const auto dependency : m_dependency_handles[handle])
+				{
+					if (execution_indices[dependency].has_value())
+					{
+						task_dependencies.push_back(execution_indices[dependency].value());
+					}
+				}
+
+				execution_indices[handle] = static_cast<std::uint32_t>(executed_tasks.size());
+				executed_tasks.push_back(handle);
+				queues.push_back(GetSubmissionQueue(handle));
+				dependencies.push_back(std::move(task_dependencies));
+			}
+
+			m_submission_plan = PlanQueueSubmissions(queues, dependencies);
+
+			// Translate the execution indices back to task handles.
+			for (auto& submission : m_submission_plan.m_submissions)
+			{
+				for (auto& task : submission.m_tasks)
+				{
+					task = executed_tasks[task];
+				}
+			}
+
+			UpdateCommandListGroups();
+		}
+
+		/*! Recalculate which consecutive tasks share a command list. */
+		/*!
+			Uses the queue submission plan, so groups never span submissions.
+		*/
+		inline void UpdateCommandListGroups()
+		{
+			m_group_leaders.resize(m_num_tasks);
+			m_group_tasks.assign(m_num_tasks, {});
+			m_group_dependencies = m_dependency_handles;
+
+			for (decltype(m_num_tasks) handle = 0; handle < m_num_tasks; ++handle)
+			{
+				m_group_leaders[handle] = handle;
+				m_group_tasks[handle].push_back(handle);
+			}
+
+			std::vector<std::uint32_t> submissions(m_num_tasks, 0u);
+			for (std::uint32_t i = 0; i < m_submission_plan.m_submissions.size(); ++i)
+			{
+				for (const auto handle : m_submission_plan.m_submissions[i].m_tasks)
+				{
+					submissions[handle] = i;
+				}
 			}
 
-			// Singlethreading behaviour
-			for (const auto handle : m_single_threaded_tasks)
+			std::vector<RenderTaskHandle> executed_tasks;
+			std::vector<CommandListGroupingInfo> tasks;
+			for (decltype(m_num_tasks) handle = 0; handle < m_num_tasks; ++handle)
 			{
-				// Skip this task if it doesn't need to be executed
 				if (!m_should_execute[handle])
 				{
 					continue;
 				}
 
-				ExecuteSingleTask(scene_graph, handle);
+				CommandListGroupingInfo info;
+				info.m_list_type = static_cast<std::uint32_t>(m_types[handle]);
+				info.m_submission = submissions[handle];
+				info.m_multithreaded = m_allow_multithreading[handle];
+				info.m_mergeable = m_num_secondary_cmd_lists[handle] == 0;
+
+				executed_tasks.push_back(handle);
+				tasks.push_back(info);
+			}
+
+			for (const auto& group : PlanCommandListGroups(tasks, m_coalescing_policy))
+			{
+				if (group.size() < 2)
+				{
+					continue;
+				}
+
+				const auto leader = executed_tasks[group.front()];
+				auto& group_tasks = m_group_tasks[leader];
+				auto& group_dependencies = m_group_dependencies[leader];
+				group_tasks.clear();
+
+				for (const auto task : group)
+				{
+					const auto handle = executed_tasks[task];
+					group_tasks.push_back(handle);
+
+					if (handle == leader)
+					{
+						continue;
+					}
+
+					m_group_leaders[handle] = leader;
+					m_group_tasks[handle].clear();
+					m_group_dependencies[handle].clear();
+
+					// The dependencies inside the group are satisfied by recording in order.
+					for (const auto dependency : m_dependency_handles[handle])
+					{
+						if (dependency < leader && std::find(group_dependencies.begin(), group_dependencies.end(), dependency) == group_dependencies.end())
+						{
+							group_dependencies.push_back(dependency);
+						}
+					}
+				}
+			}
+
+			// Only group leaders are dispatched, a task of another group is finished when its leader is.
+			for (auto& group_dependencies : m_group_dependencies)
+			{
+				for (auto& dependency : group_dependencies)
+				{
+					dependency = GetGroupLeader(dependency);
+				}
+
+				std::sort(group_dependencies.begin(), group_dependencies.end());
+				group_dependencies.erase(std::unique(group_dependencies.begin(), group_dependencies.end()), group_dependencies.end());
+			}
+		}
+
+		/*! Get the task whose command list a task records into. */
+		inline RenderTaskHandle GetGroupLeader(RenderTaskHandle handle) const
+		{
+			// The groups are recalculated when the frame graph is set up after a change.
+			return handle < m_group_leaders.size() ? m_group_leaders[handle] : handle;
+		}
+
+		/*! Check whether a task records into its own command list. */
+		inline bool IsGroupLeader(RenderTaskHandle handle) const
+		{
+			return GetGroupLeader(handle) == handle;
+		}
+
+		/*! Hand tasks to the thread pool as soon as their dependencies finished. */
+		/*!
+			Every dispatched task counts its unfinished dependencies. The tasks without any are handed out right away,
+			every other task is handed out by the last of its dependencies to finish. So a slow task only holds back the tasks that depend on it.
+			Tasks that aren't allowed to multithread run on the calling thread, which returns after they ran.
+			A task that reads a predecessor it didn't declare still waits for it inside the task. See `WaitForCompletion`.
+			\param func The function to call for every task. Receives the task handle.
+			\param filter Returns whether a task should be dispatched. Receives the task handle.
+			\param dependencies The tasks that have to finish before a task starts, indexed by task handle. Dependencies that aren't dispatched are ignored.
+			\param wait_for_tasks Wait until the tasks without dispatched successors finished before returning.
+		*/
+		template<typename F, typename P>
+		inline void Dispatch_MT_Impl(F func, P filter, std::vector<std::vector<RenderTaskHandle>> const & dependencies, bool wait_for_tasks)
+		{
+			// The tasks of the previous dispatch have finished, the frame graph waits for them before it changes.
+			auto dispatch = std::make_shared<internal::TaskDispatch>(m_num_tasks);
+			dispatch->m_func = std::move(func);
+
+			for (decltype(m_num_tasks) handle = 0; handle < m_num_tasks; ++handle)
+			{
+				// Skip this task if it doesn't need to be dispatched
+				if (filter(handle))
+				{
+					dispatch->m_states[handle].store(internal::DispatchState::PENDING, std::memory_order_relaxed);
+				}
+			}
+
+			std::vector<RenderTaskHandle> roots;
+			std::vector<RenderTaskHandle> sinks;
+			for (decltype(m_num_tasks) handle = 0; handle < m_num_tasks; ++handle)
+			{
+				if (dispatch->m_states[handle].load(std::memory_order_relaxed) == internal::DispatchState::NOT_DISPATCHED)
+				{
+					continue;
+				}
+
+				for (const auto dependency : dependencies[handle])
+				{
+					if (dispatch->m_states[dependency].load(std::memory_order_relaxed) != internal::DispatchState::NOT_DISPATCHED)
+					{
+						dispatch->m_dependencies[handle].push_back(dependency);
+						dispatch->m_successors[dependency].push_back(handle);
+					}
+				}
+
+				dispatch->m_num_pending[handle].store(static_cast<std::uint32_t>(dispatch->m_dependencies[handle].size()), std::memory_order_relaxed);
+
+				if (!m_allow_multithreading[handle])
+				{
+					dispatch->m_main_thread_only[handle] = true;
+					dispatch->m_num_unfinished_main_thread_tasks++;
+				}
+
+				if (dispatch->m_dependencies[handle].empty())
+				{
+					roots.push_back(handle);
+				}
+			}
+
+			for (decltype(m_num_tasks) handle = 0; handle < m_num_tasks; ++handle)
+			{
+				if (dispatch->m_states[handle].load(std::memory_order_relaxed) != internal::DispatchState::NOT_DISPATCHED && dispatch->m_successors[handle].empty())
+				{
+					sinks.push_back(handle);
+				}
+			}
+
+			// Publish the dispatch before the first task can wait for another one.
+			m_dispatch = dispatch;
+
+			for (const auto handle : roots)
+			{
+				ScheduleDispatchedTask(dispatch, handle);
+			}
+
+			// Run the tasks that have to run on this thread as their dependencies finish.
+			while (dispatch->m_num_unfinished_main_thread_tasks > 0)
+			{
+				std::vector<RenderTaskHandle> ready;
+				{
+					std::unique_lock<std::mutex> lock(dispatch->m_main_thread_mutex);
+					dispatch->m_main_thread_condition.wait(lock, [&dispatch] { return !dispatch->m_main_thread_tasks.empty(); });
+					std::swap(ready, dispatch->m_main_thread_tasks);
+				}
+
+				for (const auto handle : ready)
+				{
+					RunDispatchedTask(dispatch, handle);
+				}
+			}
+
+			if (wait_for_tasks)
+			{
+				for (const auto handle : sinks)
+				{
+					WaitForCompletion(handle);
+				}
+			}
+		}
+
+		/*! Hand a task whose dependencies finished to the thread pool or the dispatching thread. */
+		inline void ScheduleDispatchedTask(std::shared_ptr<internal::TaskDispatch> const & dispatch, RenderTaskHandle handle)
+		{
+			dispatch->m_states[handle].store(internal::DispatchState::READY, std::memory_order_release);
+			dispatch->m_states[handle].notify_all();
+			NotifyDispatchProgress(*dispatch);
+
+			if (dispatch->m_main_thread_only[handle])
+			{
+				{
+					std::lock_guard<std::mutex> lock(dispatch->m_main_thread_mutex);
+					dispatch->m_main_thread_tasks.push_back(handle);
+				}
+				dispatch->m_main_thread_condition.notify_one();
+			}
+			else
+			{
+				// The task can also be started by a thread that waits for it, the token isn't needed.
+				m_thread_pool->Enqueue([this, dispatch, handle]
+				{
+					RunDispatchedTask(dispatch, handle);
+				});
+			}
+		}
+
+		/*! Wake up the threads waiting for a task of the dispatch whose state didn't change. */
+		static inline void NotifyDispatchProgress(internal::TaskDispatch& dispatch)
+		{
+			dispatch.m_progress.fetch_add(1, std::memory_order_release);
+			dispatch.m_progress.notify_all();
+		}
+
+		/*! Run a ready task unless another thread already started it. */
+		/*!
+			\return Whether this thread ran the task.
+		*/
+		inline bool RunDispatchedTask(std::shared_ptr<internal::TaskDispatch> const & dispatch, RenderTaskHandle handle)
+		{
+			auto& state = dispatch->m_states[handle];
+			auto expected = internal::DispatchState::READY;
+			if (!state.compare_exchange_strong(expected, internal::DispatchState::RUNNING, std::memory_order_acq_rel))
+			{
+				return false;
+			}
+			state.notify_all();
+			NotifyDispatchProgress(*dispatch);
+
+			const auto previous_dispatch = m_running_dispatch;
+			m_running_dispatch = dispatch.get();
+			dispatch->m_func(handle);
+			m_running_dispatch = previous_dispatch;
+
+			if (dispatch->m_main_thread_only[handle])
+			{
+				dispatch->m_num_unfinished_main_thread_tasks--;
+			}
+
+			state.store(internal::DispatchState::FINISHED, std::memory_order_release);
+			state.notify_all();
+			NotifyDispatchProgress(*dispatch);
+
+			for (const auto successor : dispatch->m_successors[handle])
+			{
+				if (dispatch->m_num_pending[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					ScheduleDispatchedTask(dispatch, successor);
+				}
+			}
+
+			return true;
+		}
+
+		/*! Run the task, or one of the dependencies it waits for, on the calling thread if it is ready. */
+		/*!
+			Dependencies are earlier tasks, so the tasks started while waiting never wait for the waiting task.
+			Tasks that have to run on the dispatching thread are left alone.
+			\return Whether a task ran.
+		*/
+		inline bool RunReadyDependency(std::shared_ptr<internal::TaskDispatch> const & dispatch, RenderTaskHandle handle)
+		{
+			std::vector<RenderTaskHandle> stack = { handle };
+			std::vector<bool> visited(dispatch->m_num_tasks, false);
+
+			while (!stack.empty())
+			{
+				const auto task = stack.back();
+				stack.pop_back();
+
+				if (visited[task])
+				{
+					continue;
+				}
+				visited[task] = true;
+
+				const auto state = dispatch->m_states[task].load(std::memory_order_acquire);
+				if (state == internal::DispatchState::READY && !dispatch->m_main_thread_only[task])
+				{
+					if (RunDispatchedTask(dispatch, task))
+					{
+						return true;
+					}
+				}
+				else if (state == internal::DispatchState::PENDING)
+				{
+					stack.insert(stack.end(), dispatch->m_dependencies[task].begin(), dispatch->m_dependencies[task].end());
+				}
+			}
+
+			return false;
+		}
+
+		/*! Check whether a task of a dispatch finished. Tasks that weren't dispatched count as finished. */
+		static inline bool IsDispatchFinished(internal::TaskDispatch const & dispatch, RenderTaskHandle handle)
+		{
+			if (handle >= dispatch.m_num_tasks)
+			{
+				return true;
+			}
+
+			const auto state = dispatch.m_states[handle].load(std::memory_order_acquire);
+			return state == internal::DispatchState::NOT_DISPATCHED || state == internal::DispatchState::FINISHED;
+		}
+
+		/*! Setup tasks multi threaded */
+		inline void Setup_MT_Impl()
+		{
+			Dispatch_MT_Impl([this](RenderTaskHandle handle)
+			{
+				CallSetupFunction(handle, false);
+			}, [this](RenderTaskHandle handle) { return !m_is_setup[handle]; }, m_dependency_handles, true);
+		}
+
+		/*! Destroy and set up the resized tasks multi threaded */
+		inline void Resize_MT_Impl()
+		{
+			Dispatch_MT_Impl([this](RenderTaskHandle handle)
+			{
+				ResetResizedTask(handle);
+			}, [this](RenderTaskHandle handle) { return m_resolution_dependent[handle] && m_is_setup[handle]; }, m_dependency_handles, true);
+		}
+
+		/*! Resize the render target of a task to the new output size. */
+		inline void ResizeTaskRenderTarget(RenderTaskHandle handle, std::uint32_t width, std::uint32_t height)
+		{
+			if (m_rt_properties[handle].has_value() && !m_rt_properties[handle].value().m_is_render_window)
+			{
+				m_render_system->ResizeRenderTarget(&m_render_targets[handle],
+					static_cast<std::uint32_t>(std::ceil(width * m_rt_properties[handle].value().m_resolution_scale.Get())),
+					static_cast<std::uint32_t>(std::ceil(height * m_rt_properties[handle].value().m_resolution_scale.Get())));
 			}
 		}
 
+		/*! Destroy a task whose render target was resized and set it up again. */
+		inline void ResetResizedTask(RenderTaskHandle handle)
+		{
+			m_destroy_funcs[handle](*this, handle, true);
+
+			m_resource_usages[handle].clear();
+			m_resource_initial_states[handle].clear();
+			m_setup_lookups[handle].clear();
+			m_fingerprints[handle] = std::nullopt;
+			CallSetupFunction(handle, true);
+		}
+
+		/*! Call the setup function of a task */
+		inline void CallSetupFunction(RenderTaskHandle handle, bool resize)
+		{
+#ifdef FG_ENABLE_PROFILING
+			FrameGraphProfiler::ScopedEvent event(m_profiler, FrameGraphProfiler::EventType::SETUP, handle);
+#endif
+
+			// Remember which task is being set up on this thread so `GetHandleFromType` can record its lookups.
+			const auto previous_task_in_setup = m_task_in_setup;
+			const auto previous_view = m_current_view;
+			m_task_in_setup = { this, handle };
+			m_current_view = { this, m_views[handle] };
+
+			m_setup_funcs[handle](*m_render_system, *this, handle, resize);
+
+			m_task_in_setup = previous_task_in_setup;
+			m_current_view = previous_view;
+		}
+
+		/*! Execute tasks multi threaded */
+		/*!
+			Tasks that share a command list are dispatched as a group, after the dependencies of all tasks in the group.
+			Doesn't wait for the tasks, the command lists are collected with `WaitForCompletion` as they finish recording.
+		*/
+		inline void Execute_MT_Impl(SceneGraph& scene_graph)
+		{
+			Dispatch_MT_Impl([this, &scene_graph](RenderTaskHandle handle)
+			{
+				ExecuteCommandListGroup(scene_graph, handle);
+			}, [this](RenderTaskHandle handle) { return m_should_execute[handle] && IsGroupLeader(handle); }, m_group_dependencies, false);
+		}
+
 		/*! Execute tasks single threaded */
 		inline void Execute_ST_Impl(SceneGraph& scene_graph)
 		{
 			for (decltype(m_num_tasks) i = 0; i < m_num_tasks; ++i)
 			{
-				// Skip this task if it doesn't need to be executed
-				if (!m_should_execute[i])
+				// Skip this task if it doesn't need to be executed or is recorded by the first task of its group.
+				if (!m_should_execute[i] || !IsGroupLeader(i))
 				{
 					continue;
 				}
 
-				ExecuteSingleTask(scene_graph, i);
+				ExecuteCommandListGroup(scene_graph, i);
+			}
+		}
+
+		/*! Record the tasks that share the command list of a group leader. */
+		inline void ExecuteCommandListGroup(SceneGraph& sg, RenderTaskHandle leader)
+		{
+			const auto previous_group = m_recording_group;
+			m_recording_group = { this, leader };
+
+			auto cmd_list = m_cmd_lists[leader];
+			m_render_system->ResetCommandList(cmd_list);
+
+			for (const auto handle : m_group_tasks[leader])
+			{
+				cmd_list = ExecuteSingleTask(sg, handle, cmd_list);
 			}
+
+			m_render_system->CloseCommandList(cmd_list);
+
+			m_recording_group = previous_group;
 		}
 
 		/*! Execute a single task */
-		inline void ExecuteSingleTask(SceneGraph& sg, RenderTaskHandle handle)
+		/*!
+			\param cmd_list The open command list to record the task into.
+			\return The command list recording continues in. This is the closing command list for tasks that record secondary command lists.
+		*/
+		inline CommandList* ExecuteSingleTask(SceneGraph& sg, RenderTaskHandle handle, CommandList* cmd_list)
 		{
-			auto cmd_list = m_cmd_lists[handle];
+#ifdef FG_ENABLE_PROFILING
+			FrameGraphProfiler::ScopedEvent event(m_profiler, FrameGraphProfiler::EventType::EXECUTE, handle);
+#endif
+
 			auto render_target = m_render_targets[handle];
 			auto rt_properties = m_rt_properties[handle];
 
-			m_render_system->ResetCommandList(cmd_list);
+			m_num_recorded_secondary_cmd_lists[handle] = 0;
+
+			// Lookups made by the task resolve to the tasks of its view.
+			const auto previous_view = m_current_view;
+			m_current_view = { this, m_views[handle] };
+
+			if (!m_barriers_before[handle].empty())
+			{
+				m_render_system->RecordResourceBarriers(cmd_list, m_barriers_before[handle]);
+			}
 
 			switch (m_types[handle])
 			{
@@ -952,6 +2797,7 @@ namespace wr
 					m_render_system->StartRenderTask(cmd_list, { render_target, rt_properties.value() });
 				}
 				m_execute_funcs[handle](*m_render_system, *this, sg, handle);
+				cmd_list = BeginClosingCommandList(handle);
 				if (rt_properties.has_value())
 				{
 					m_render_system->StopRenderTask(cmd_list, { render_target, rt_properties.value() });
@@ -963,6 +2809,7 @@ namespace wr
 					m_render_system->StartComputeTask(cmd_list, { render_target, rt_properties.value() });
 				}
 				m_execute_funcs[handle](*m_render_system, *this, sg, handle);
+				cmd_list = BeginClosingCommandList(handle);
 				if (rt_properties.has_value())
 				{
 					m_render_system->StopComputeTask(cmd_list, { render_target, rt_properties.value() });
@@ -974,6 +2821,7 @@ namespace wr
 					m_render_system->StartCopyTask(cmd_list, { render_target, rt_properties.value() });
 				}
 				m_execute_funcs[handle](*m_render_system, *this, sg, handle);
+				cmd_list = BeginClosingCommandList(handle);
 				if (rt_properties.has_value())
 				{
 					m_render_system->StopCopyTask(cmd_list, { render_target, rt_properties.value() });
@@ -981,7 +2829,92 @@ namespace wr
 				break;
 			}
 
-			m_render_system->CloseCommandList(cmd_list);
+			if (!m_barriers_after[handle].empty())
+			{
+				m_render_system->RecordResourceBarriers(cmd_list, m_barriers_after[handle]);
+			}
+
+			m_current_view = previous_view;
+
+			return cmd_list;
+		}
+
+		/*! Continue recording a task in its closing command list. */
+		/*!
+			The secondary command lists recorded by `RecordParallel` are executed between the command list of the task and the closing one.
+			So the render target transitions and the barriers after the task are recorded in the closing command list.
+			\return The command list to continue recording in.
+		*/
+		inline CommandList* BeginClosingCommandList(RenderTaskHandle handle)
+		{
+			// Tasks without secondary command lists keep recording into the command list they share with their group.
+			if (!m_closing_cmd_lists[handle])
+			{
+				return GetCommandList(handle);
+			}
+
+			m_render_system->CloseCommandList(m_cmd_lists[handle]);
+			m_render_system->ResetCommandList(m_closing_cmd_lists[handle]);
+
+			return m_closing_cmd_lists[handle];
+		}
+
+		/*! Add the command lists of a task in submission order. */
+		template<typename T>
+		inline void AppendCommandLists(std::vector<T*>& cmd_lists, RenderTaskHandle handle)
+		{
+			// Tasks merged into the command list of an earlier task don't submit one of their own.
+			if (!IsGroupLeader(handle))
+			{
+				return;
+			}
+
+			cmd_lists.push_back(static_cast<T*>(m_cmd_lists[handle]));
+
+			if (m_closing_cmd_lists[handle])
+			{
+				for (std::uint32_t i = 0; i < m_num_recorded_secondary_cmd_lists[handle]; ++i)
+				{
+					cmd_lists.push_back(static_cast<T*>(m_secondary_cmd_lists[handle][i]));
+				}
+
+				cmd_lists.push_back(static_cast<T*>(m_closing_cmd_lists[handle]));
+			}
+		}
+
+		/*! Destroy the command lists of a task. */
+		inline void DestroyCommandLists(RenderTaskHandle handle)
+		{
+			if (m_cmd_lists[handle])
+			{
+				m_render_system->DestroyCommandList(m_cmd_lists[handle]);
+				m_cmd_lists[handle] = nullptr;
+			}
+
+			for (auto cmd_list : m_secondary_cmd_lists[handle])
+			{
+				m_render_system->DestroyCommandList(cmd_list);
+			}
+			m_secondary_cmd_lists[handle].clear();
+
+			if (m_closing_cmd_lists[handle])
+			{
+				m_render_system->DestroyCommandList(m_closing_cmd_lists[handle]);
+				m_closing_cmd_lists[handle] = nullptr;
+			}
+		}
+
+		/*! Record the chunks of a parallel recording until none are left. Called by `RecordParallel`. */
+		static inline void RecordChunks(internal::ParallelRecording& recording)
+		{
+			for (auto chunk = recording.m_next_chunk++; chunk < recording.m_num_chunks; chunk = recording.m_next_chunk++)
+			{
+				recording.m_record(chunk);
+				if (recording.m_finished_chunks.fetch_add(1, std::memory_order_acq_rel) + 1 == recording.m_num_chunks)
+				{
+					recording.m_finished_chunks.notify_all();
+				}
+			}
 		}
 
 		/*! Get a free unique ID. */
@@ -1010,9 +2943,32 @@ namespace wr
 		/*! The thread pool used for multithreading */
 		util::ThreadPool* m_thread_pool;
 
-		/*! Vectors which allow us to itterate over only single threader or only multithreaded tasks. */
-		std::vector<RenderTaskHandle> m_multi_threaded_tasks;
-		std::vector<RenderTaskHandle> m_single_threaded_tasks;
+		/*! Defines whether a task is allowed to run on the thread pool. */
+		std::vector<bool> m_allow_multithreading;
+		/*! Defines whether the render target of a task is transient. */
+		std::vector<bool> m_transient;
+		/*! Defines whether a task has to be resized when the output resolution changes. */
+		std::vector<bool> m_resolution_dependent;
+		/*! How the transient render targets can share memory. Calculated by `GetRenderTargetAliasingPlan`. */
+		mutable std::optional<RenderTargetAliasingPlan> m_aliasing_plan;
+		/*! The resources the tasks declared during setup. */
+		std::vector<std::vector<ResourceUsage>> m_resource_usages;
+		std::vector<std::vector<ResourceInitialState>> m_resource_initial_states;
+		/*! Barriers recorded by the frame graph before and after a task executes. */
+		std::vector<std::vector<ResourceBarrier>> m_barriers_before;
+		std::vector<std::vector<ResourceBarrier>> m_barriers_after;
+		/*! How the executed tasks are submitted to the direct and compute queue. */
+		QueueSubmissionPlan m_submission_plan;
+		/*! How consecutive tasks are merged into a single command list. */
+		CommandListCoalescingPolicy m_coalescing_policy;
+		/*! The task whose command list a task records into. The first task of its group. */
+		std::vector<RenderTaskHandle> m_group_leaders;
+		/*! The tasks a group leader records in order, including itself. Empty for tasks that aren't group leaders. */
+		std::vector<std::vector<RenderTaskHandle>> m_group_tasks;
+		/*! The tasks a group leader waits for before its group is dispatched. */
+		std::vector<std::vector<RenderTaskHandle>> m_group_dependencies;
+		/*! The frame graph and group leader whose command list is recorded on this thread. */
+		static inline thread_local std::pair<FrameGraph const *, RenderTaskHandle> m_recording_group = { nullptr, 0 };
 
 		/*! Holds the textures that can be written to memory. */
 		CPUTextures m_output_cpu_textures;
@@ -1023,26 +2979,76 @@ namespace wr
 		std::vector<destroy_func_t> m_destroy_funcs;
 		/*! Task target and command list. */
 		std::vector<CommandList*> m_cmd_lists;
+		/*! Command lists recorded in parallel by `RecordParallel`, and the command list that finishes the task after them. */
+		std::vector<std::uint32_t> m_num_secondary_cmd_lists;
+		std::vector<std::vector<CommandList*>> m_secondary_cmd_lists;
+		std::vector<CommandList*> m_closing_cmd_lists;
+		std::vector<std::uint32_t> m_num_recorded_secondary_cmd_lists;
 		std::vector<RenderTarget*> m_render_targets;
 		/*! Task data and the type information of the original data structure. */
 		std::vector<std::shared_ptr<void>> m_data;
+		std::vector<std::shared_ptr<void>(*)()> m_data_factories;
 		std::vector<std::reference_wrapper<const std::type_info>> m_data_type_info;
+		std::vector<std::uint32_t> m_type_indices;
+		/*! Task handles indexed by the type index of the task data. See `internal::GetFrameGraphTypeIndex`. */
+		std::vector<std::optional<RenderTaskHandle>> m_handles_by_type;
+		/*! The view a task belongs to. `std::nullopt` for tasks shared by all views. See `ForView`. */
+		std::vector<std::optional<std::uint32_t>> m_views;
+		/*! Task handles indexed by the type index of the task data and the view. */
+		std::vector<std::vector<std::optional<RenderTaskHandle>>> m_view_handles_by_type;
+		/*! The cameras of the views. Set with `SetViewCamera`. */
+		std::vector<std::shared_ptr<CameraNode>> m_view_cameras;
+		/*! The frame graph and view that tasks are added to and looked up in on this thread. */
+		static inline thread_local std::pair<FrameGraph const *, std::optional<std::uint32_t>> m_current_view = { nullptr, std::nullopt };
 		/*! Task settings that can be passed to the frame graph from outside the task. */
-		std::vector<std::optional<std::any>> m_settings;
-		/*! Defines whether a task should execute or not. */
+		std::vector<std::unique_ptr<TaskSettingsBase>> m_settings;
+		/*! Defines whether a task should execute or not. This is false for disabled and culled tasks. */
 		std::vector<bool> m_should_execute;
+		/*! Defines whether a task is enabled with `SetShouldExecute`. */
+		std::vector<bool> m_enabled;
+		/*! Input fingerprints of the tasks. See `RenderTaskDesc::m_fingerprint_func`. */
+		std::vector<fingerprint_func_t> m_fingerprint_funcs;
+		/*! The fingerprint of the last time a task executed. `std::nullopt` if the task has to execute. */
+		std::vector<std::optional<std::uint64_t>> m_fingerprints;
+		/*! The fingerprints calculated this frame. */
+		std::vector<std::uint64_t> m_new_fingerprints;
+		/*! Defines whether a task is skipped because its fingerprint didn't change. */
+		std::vector<bool> m_memoized;
+		/*! Defines whether a task is an output of the frame graph. Used for culling. */
+		std::vector<bool> m_is_output;
+		/*! Set when an output changed so the culling is recalculated during the next `Execute`. */
+		bool m_outputs_changed = false;
 		/*! Used to queue a request to change the should execute value */
 		std::queue<std::pair<RenderTaskHandle, bool>> m_should_execute_change_request;
-		/*! Descriptions of the tasks. */
-#ifndef FG_MAX_PERFORMANCE
 		/*! Stored the dependencies of a task. */
 		std::vector<std::vector<std::reference_wrapper<const std::type_info>>> m_dependencies;
+		/*! The dependencies of a task resolved to task handles by `CompileDependencies`. */
+		std::vector<std::vector<RenderTaskHandle>> m_dependency_handles;
+		/*! The type indices a task looked up during its setup. Used to find the tasks affected by a change to the frame graph. */
+		mutable std::vector<std::vector<std::uint32_t>> m_setup_lookups;
+		/*! Defines whether a task is set up. False for new tasks and tasks torn down by a change to the frame graph. */
+		std::vector<bool> m_is_setup;
+		/*! Where `AddTask` inserts new tasks. Appends when empty. */
+		std::optional<RenderTaskHandle> m_insert_position;
+		/*! Set when tasks have to be set up before the next `Execute`. */
+		bool m_has_pending_changes = false;
+		/*! The frame graph and task whose setup function is running on this thread. */
+		static inline thread_local std::pair<FrameGraph const *, RenderTaskHandle> m_task_in_setup = { nullptr, 0 };
+		/*! Descriptions of the tasks. */
+#ifndef FG_MAX_PERFORMANCE
 		/*! The names of the render targets meant for debugging */
 		std::vector<std::wstring> m_names;
 #endif
 		std::vector<RenderTaskType> m_types;
 		std::vector<std::optional<RenderTargetProperties>> m_rt_properties;
-		std::vector<std::future<void>> m_futures;
+		/*! The tasks handed to the thread pool by the last `Dispatch_MT_Impl`. */
+		std::shared_ptr<internal::TaskDispatch> m_dispatch;
+		/*! The dispatch whose task runs on this thread. */
+		static inline thread_local internal::TaskDispatch const * m_running_dispatch = nullptr;
+#ifdef FG_ENABLE_PROFILING
+		/*! Records the timings of the tasks. */
+		FrameGraphProfiler m_profiler;
+#endif
 
 		const std::uint64_t m_uid;
 		static inline std::uint64_t m_largest_uid = 0;
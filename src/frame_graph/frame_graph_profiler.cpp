@@ -0,0 +1,338 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "frame_graph_profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace wr
+{
+
+	namespace internal
+	{
+
+		static thread_local std::uint32_t profiler_current_task = FrameGraphProfiler::no_task;
+
+		static std::atomic<std::uint32_t> profiler_thread_counter = 0;
+
+		inline double NanosecondsToMilliseconds(std::uint64_t ns)
+		{
+			return static_cast<double>(ns) / 1000000.0;
+		}
+
+		inline std::string EscapeJson(std::string const & str)
+		{
+			std::string retval;
+			retval.reserve(str.size());
+
+			for (auto c : str)
+			{
+				if (c == '"' || c == '\\')
+				{
+					retval.push_back('\\');
+				}
+				retval.push_back(c);
+			}
+
+			return retval;
+		}
+
+		inline const char* EventTypeToStr(FrameGraphProfiler::EventType type)
+		{
+			switch (type)
+			{
+			case FrameGraphProfiler::EventType::SETUP: return "setup";
+			case FrameGraphProfiler::EventType::EXECUTE: return "execute";
+			case FrameGraphProfiler::EventType::WAIT: return "wait";
+			case FrameGraphProfiler::EventType::SUBMIT: return "submit";
+			default: return "unknown";
+			}
+		}
+
+	} /* internal */
+
+	FrameGraphProfiler::ScopedEvent::ScopedEvent(FrameGraphProfiler& profiler, EventType type, std::uint32_t task) :
+		m_profiler(profiler),
+		m_type(type),
+		m_task(task),
+		m_previous_task(FrameGraphProfiler::GetCurrentTask()),
+		m_begin(clock_t::now())
+	{
+		FrameGraphProfiler::SetCurrentTask(task);
+	}
+
+	FrameGraphProfiler::ScopedEvent::~ScopedEvent()
+	{
+		m_profiler.Record(m_type, m_task, m_begin, clock_t::now());
+		FrameGraphProfiler::SetCurrentTask(m_previous_task);
+	}
+
+	FrameGraphProfiler::FrameGraphProfiler() :
+		m_start(clock_t::now()),
+		m_frame(0),
+		m_events(std::make_unique<util::RingBuffer<Event, max_events>>())
+	{
+	}
+
+	void FrameGraphProfiler::InsertTask(std::uint32_t task, std::wstring const & name)
+	{
+		m_names.emplace(m_names.begin() + task, name.begin(), name.end());
+		m_dependencies.emplace(m_dependencies.begin() + task);
+	}
+
+	void FrameGraphProfiler::RemoveTask(std::uint32_t task)
+	{
+		m_names.erase(m_names.begin() + task);
+		m_dependencies.erase(m_dependencies.begin() + task);
+	}
+
+	void FrameGraphProfiler::SetDependencies(std::vector<std::vector<std::uint32_t>> const & dependencies)
+	{
+		m_dependencies = dependencies;
+		m_dependencies.resize(m_names.size());
+	}
+
+	void FrameGraphProfiler::RemoveTasks()
+	{
+		m_names.clear();
+		m_dependencies.clear();
+	}
+
+	void FrameGraphProfiler::BeginFrame()
+	{
+		m_frame.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	std::uint64_t FrameGraphProfiler::GetFrame() const
+	{
+		return m_frame.load(std::memory_order_relaxed);
+	}
+
+	void FrameGraphProfiler::Record(EventType type, std::uint32_t task, clock_t::time_point begin, clock_t::time_point end, std::uint32_t waited_task)
+	{
+		Event event;
+		event.m_frame = GetFrame();
+		event.m_begin = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(begin - m_start).count());
+		event.m_end = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_start).count());
+		event.m_task = task;
+		event.m_waited_task = waited_task;
+		event.m_thread = GetThreadID();
+		event.m_type = type;
+
+		m_events->Push(event);
+	}
+
+	std::vector<FrameGraphProfiler::Event> FrameGraphProfiler::GetEvents() const
+	{
+		return m_events->Snapshot();
+	}
+
+	FrameGraphProfiler::FrameStats FrameGraphProfiler::GetFrameStats(std::uint64_t frame) const
+	{
+		FrameStats stats;
+		stats.m_frame = frame;
+		stats.m_tasks.resize(m_names.size());
+
+		std::uint64_t frame_begin = std::numeric_limits<std::uint64_t>::max();
+		std::uint64_t frame_end = 0u;
+		std::uint64_t first_submission_end = std::numeric_limits<std::uint64_t>::max();
+
+		for (auto const & event : GetEvents())
+		{
+			if (event.m_frame != frame || event.m_task >= stats.m_tasks.size())
+			{
+				continue;
+			}
+
+			auto& task = stats.m_tasks[event.m_task];
+			const auto duration = internal::NanosecondsToMilliseconds(event.m_end - event.m_begin);
+
+			switch (event.m_type)
+			{
+			case EventType::SETUP:
+				task.m_setup_ms += duration;
+				break;
+			case EventType::EXECUTE:
+				task.m_execute_ms += duration;
+				frame_begin = std::min(frame_begin, event.m_begin);
+				frame_end = std::max(frame_end, event.m_end);
+				break;
+			case EventType::WAIT:
+				task.m_wait_ms += duration;
+				break;
+			case EventType::SUBMIT:
+				stats.m_num_submissions++;
+				stats.m_submit_ms += duration;
+				first_submission_end = std::min(first_submission_end, event.m_end);
+				break;
+			}
+		}
+
+		if (frame_end > frame_begin)
+		{
+			stats.m_frame_ms = internal::NanosecondsToMilliseconds(frame_end - frame_begin);
+		}
+
+		if (stats.m_num_submissions > 0 && first_submission_end > frame_begin)
+		{
+			stats.m_first_submission_ms = internal::NanosecondsToMilliseconds(first_submission_end - frame_begin);
+		}
+
+		// Time spent waiting is part of the execute time but doesn't make the chain any longer.
+		std::vector<double> durations(stats.m_tasks.size());
+		for (std::size_t i = 0; i < durations.size(); ++i)
+		{
+			durations[i] = std::max(0.0, stats.m_tasks[i].m_execute_ms - stats.m_tasks[i].m_wait_ms);
+		}
+
+		stats.m_critical_path = FindCriticalPath(durations, m_dependencies);
+		for (auto task : stats.m_critical_path)
+		{
+			stats.m_critical_path_ms += durations[task];
+		}
+
+		return stats;
+	}
+
+	std::vector<std::string> const & FrameGraphProfiler::GetTaskNames() const
+	{
+		return m_names;
+	}
+
+	std::string FrameGraphProfiler::ExportChromeTrace() const
+	{
+		std::ostringstream ss;
+		ss << "{\"traceEvents\":[";
+
+		bool first = true;
+		for (auto const & event : GetEvents())
+		{
+			auto name = GetTaskName(event.m_task);
+			if (event.m_type == EventType::WAIT)
+			{
+				name = "Wait for " + GetTaskName(event.m_waited_task);
+			}
+			else if (event.m_type == EventType::SUBMIT)
+			{
+				name = "Submit " + GetTaskName(event.m_task) + " to " + GetTaskName(event.m_waited_task);
+			}
+
+			ss << (first ? "\n" : ",\n");
+			ss << "{\"name\":\"" << internal::EscapeJson(name) << "\""
+				<< ",\"cat\":\"" << internal::EventTypeToStr(event.m_type) << "\""
+				<< ",\"ph\":\"X\""
+				<< ",\"ts\":" << static_cast<double>(event.m_begin) / 1000.0
+				<< ",\"dur\":" << static_cast<double>(event.m_end - event.m_begin) / 1000.0
+				<< ",\"pid\":0"
+				<< ",\"tid\":" << event.m_thread
+				<< ",\"args\":{\"frame\":" << event.m_frame << "}}";
+
+			first = false;
+		}
+
+		ss << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+		return ss.str();
+	}
+
+	bool FrameGraphProfiler::SaveChromeTrace(std::string const & path) const
+	{
+		std::ofstream file(path);
+
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		file << ExportChromeTrace();
+
+		return file.good();
+	}
+
+	std::uint32_t FrameGraphProfiler::GetCurrentTask()
+	{
+		return internal::profiler_current_task;
+	}
+
+	void FrameGraphProfiler::SetCurrentTask(std::uint32_t task)
+	{
+		internal::profiler_current_task = task;
+	}
+
+	std::uint32_t FrameGraphProfiler::GetThreadID()
+	{
+		static thread_local const std::uint32_t id = internal::profiler_thread_counter++;
+		return id;
+	}
+
+	std::string FrameGraphProfiler::GetTaskName(std::uint32_t task) const
+	{
+		if (task == no_task)
+		{
+			return "Frame Graph";
+		}
+		else if (task < m_names.size())
+		{
+			return m_names[task];
+		}
+
+		return "Task " + std::to_string(task);
+	}
+
+	std::vector<std::uint32_t> FindCriticalPath(std::vector<double> const & durations, std::vector<std::vector<std::uint32_t>> const & dependencies)
+	{
+		if (durations.empty())
+		{
+			return {};
+		}
+
+		// Longest path ending at every task and the task before it on that path.
+		std::vector<double> path_lengths(durations.size(), 0.0);
+		std::vector<std::uint32_t> previous(durations.size(), FrameGraphProfiler::no_task);
+
+		for (std::uint32_t task = 0; task < durations.size(); ++task)
+		{
+			double longest = 0.0;
+
+			if (task < dependencies.size())
+			{
+				for (auto dependency : dependencies[task])
+				{
+					if (dependency < task && path_lengths[dependency] > longest)
+					{
+						longest = path_lengths[dependency];
+						previous[task] = dependency;
+					}
+				}
+			}
+
+			path_lengths[task] = longest + durations[task];
+		}
+
+		auto last = static_cast<std::uint32_t>(std::distance(path_lengths.begin(), std::max_element(path_lengths.begin(), path_lengths.end())));
+
+		std::vector<std::uint32_t> path;
+		for (auto task = last; task != FrameGraphProfiler::no_task; task = previous[task])
+		{
+			path.push_back(task);
+		}
+		std::reverse(path.begin(), path.end());
+
+		return path;
+	}
+
+} /* wr */
@@ -0,0 +1,165 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../util/ring_buffer.hpp"
+
+namespace wr
+{
+
+	//! Frame Graph Profiler
+	/*!
+		Records how long the frame graph tasks spend in setup, in execute and waiting for other tasks.
+		Events are stored in a lock-free ring buffer so the worker threads can record them without locking.
+		The frame graph only records events when `FG_ENABLE_PROFILING` is defined.
+	*/
+	class FrameGraphProfiler
+	{
+	public:
+		using clock_t = std::chrono::steady_clock;
+
+		static constexpr std::uint32_t no_task = std::numeric_limits<std::uint32_t>::max();
+		static constexpr std::size_t max_events = 16384;
+
+		enum class EventType : std::uint8_t
+		{
+			SETUP,
+			EXECUTE,
+			WAIT,
+			SUBMIT,
+		};
+
+		struct Event
+		{
+			std::uint64_t m_frame = 0u;
+			/*! Nanoseconds since the profiler was created. */
+			std::uint64_t m_begin = 0u;
+			std::uint64_t m_end = 0u;
+			/*! The task that recorded the event. `no_task` when recorded outside of a task. For `SUBMIT` events the first task of the batch. */
+			std::uint32_t m_task = no_task;
+			/*! The task that was waited for. Only used by `WAIT` events. For `SUBMIT` events the last task of the batch. */
+			std::uint32_t m_waited_task = no_task;
+			std::uint32_t m_thread = 0u;
+			EventType m_type = EventType::EXECUTE;
+		};
+
+		struct TaskStats
+		{
+			double m_setup_ms = 0.0;
+			double m_execute_ms = 0.0;
+			double m_wait_ms = 0.0;
+		};
+
+		struct FrameStats
+		{
+			std::uint64_t m_frame = 0u;
+			/*! Time between the start of the first and the end of the last task. */
+			double m_frame_ms = 0.0;
+			/*! Indexed by task handle. */
+			std::vector<TaskStats> m_tasks;
+			/*! Task handles on the longest chain of dependent tasks, in execution order. */
+			std::vector<std::uint32_t> m_critical_path;
+			double m_critical_path_ms = 0.0;
+			/*! Number of streamed command list submissions. See `FrameGraph::StreamCommandLists`. */
+			std::uint32_t m_num_submissions = 0u;
+			double m_submit_ms = 0.0;
+			/*! Time between the start of the first task and the end of the first submission. How long the GPU waited for work. */
+			double m_first_submission_ms = 0.0;
+		};
+
+		//! Records an event for the lifetime of the object.
+		/*!
+			Also marks the task as the task executing on this thread, so waits inside the task are attributed to it.
+		*/
+		class ScopedEvent
+		{
+		public:
+			ScopedEvent(FrameGraphProfiler& profiler, EventType type, std::uint32_t task);
+			~ScopedEvent();
+
+			ScopedEvent(ScopedEvent const &) = delete;
+			ScopedEvent& operator=(ScopedEvent const &) = delete;
+
+		private:
+			FrameGraphProfiler& m_profiler;
+			EventType m_type;
+			std::uint32_t m_task;
+			std::uint32_t m_previous_task;
+			clock_t::time_point m_begin;
+		};
+
+		FrameGraphProfiler();
+
+		/*! Register a task at the position it has in the frame graph. Tasks after it move one position. */
+		void InsertTask(std::uint32_t task, std::wstring const & name);
+		/*! Unregister a task. Tasks after it move one position. Recorded events keep the old positions. */
+		void RemoveTask(std::uint32_t task);
+		/*! Set the dependencies of every task as task handles. */
+		void SetDependencies(std::vector<std::vector<std::uint32_t>> const & dependencies);
+		/*! Remove all tasks. Recorded events are kept. */
+		void RemoveTasks();
+
+		/*! Start a new frame. Events recorded after this belong to the new frame. */
+		void BeginFrame();
+		std::uint64_t GetFrame() const;
+
+		void Record(EventType type, std::uint32_t task, clock_t::time_point begin, clock_t::time_point end, std::uint32_t waited_task = no_task);
+
+		/*! All events that are still in the ring buffer, oldest first. */
+		std::vector<Event> GetEvents() const;
+		/*! Statistics of a frame. Only frames that are still in the ring buffer have data. */
+		FrameStats GetFrameStats(std::uint64_t frame) const;
+		std::vector<std::string> const & GetTaskNames() const;
+
+		/*! Convert the events to the Chrome trace event format. Open the file with `chrome://tracing`. */
+		std::string ExportChromeTrace() const;
+		bool SaveChromeTrace(std::string const & path) const;
+
+		/*! The task executing on the calling thread. */
+		static std::uint32_t GetCurrentTask();
+
+	private:
+		static void SetCurrentTask(std::uint32_t task);
+		static std::uint32_t GetThreadID();
+
+		std::string GetTaskName(std::uint32_t task) const;
+
+		clock_t::time_point m_start;
+		std::atomic<std::uint64_t> m_frame;
+		std::vector<std::string> m_names;
+		std::vector<std::vector<std::uint32_t>> m_dependencies;
+		std::unique_ptr<util::RingBuffer<Event, max_events>> m_events;
+	};
+
+	//! Find the critical path of a frame.
+	/*!
+		The critical path is the chain of dependent tasks with the largest total duration.
+		Tasks are in execution order so dependencies always have a lower index.
+		\param durations The duration of every task.
+		\param dependencies The dependencies of every task.
+		\return The tasks on the path in execution order.
+	*/
+	std::vector<std::uint32_t> FindCriticalPath(std::vector<double> const & durations, std::vector<std::vector<std::uint32_t>> const & dependencies);
+
+} /* wr */
@@ -0,0 +1,109 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "queue_submissions.hpp"
+
+#include <algorithm>
+
+namespace wr
+{
+
+	QueueSubmissionPlan PlanQueueSubmissions(std::vector<SubmissionQueue> const & queues, std::vector<std::vector<std::uint32_t>> const & dependencies)
+	{
+		constexpr auto num_queues = 2u;
+
+		QueueSubmissionPlan plan;
+
+		std::vector<std::uint32_t> task_submissions(queues.size(), 0u);
+		// The submission tasks of a queue are currently added to.
+		std::optional<std::uint32_t> open[num_queues] = { std::nullopt, std::nullopt };
+		// The last submission of the other queue a queue waited for.
+		std::optional<std::uint32_t> waited[num_queues] = { std::nullopt, std::nullopt };
+
+		for (std::uint32_t task = 0; task < queues.size(); ++task)
+		{
+			const auto queue = static_cast<std::uint32_t>(queues[task]);
+			const auto other = (queue + 1u) % num_queues;
+
+			// Find the last submission of the other queue this task depends on.
+			std::optional<std::uint32_t> required = std::nullopt;
+			if (task < dependencies.size())
+			{
+				for (const auto dependency : dependencies[task])
+				{
+					if (dependency >= task)
+					{
+						continue;
+					}
+
+					const auto submission = task_submissions[dependency];
+					if (plan.m_submissions[submission].m_queue != queues[task])
+					{
+						required = std::max(required.value_or(0u), submission);
+					}
+				}
+			}
+
+			if (required.has_value() && (!waited[queue].has_value() || waited[queue].value() < required.value()))
+			{
+				// The other queue has to signal after the submission we wait for, so don't add more work to it.
+				plan.m_submissions[required.value()].m_signal = true;
+				if (open[other] == required)
+				{
+					open[other] = std::nullopt;
+				}
+
+				QueueSubmission submission;
+				submission.m_queue = queues[task];
+				submission.m_wait_for = required;
+				plan.m_submissions.push_back(submission);
+				plan.m_num_waits++;
+
+				open[queue] = static_cast<std::uint32_t>(plan.m_submissions.size() - 1);
+				waited[queue] = required;
+			}
+			else if (!open[queue].has_value())
+			{
+				QueueSubmission submission;
+				submission.m_queue = queues[task];
+				plan.m_submissions.push_back(submission);
+
+				open[queue] = static_cast<std::uint32_t>(plan.m_submissions.size() - 1);
+			}
+
+			plan.m_submissions[open[queue].value()].m_tasks.push_back(task);
+			task_submissions[task] = open[queue].value();
+		}
+
+		// The frame is finished when the direct queue is, so it has to wait for the remaining compute work.
+		const auto direct = static_cast<std::uint32_t>(SubmissionQueue::DIRECT);
+		for (auto i = plan.m_submissions.size(); i-- > 0;)
+		{
+			if (plan.m_submissions[i].m_queue == SubmissionQueue::COMPUTE)
+			{
+				if (!waited[direct].has_value() || waited[direct].value() < i)
+				{
+					plan.m_submissions[i].m_signal = true;
+					plan.m_wait_at_end = static_cast<std::uint32_t>(i);
+					plan.m_num_waits++;
+				}
+				break;
+			}
+		}
+
+		return plan;
+	}
+
+} /* wr */
@@ -0,0 +1,74 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "../wisprenderer_export.hpp"
+
+namespace wr
+{
+
+	/*! The queue a task is submitted to. */
+	enum class SubmissionQueue
+	{
+		DIRECT,
+		COMPUTE,
+	};
+
+	//! Queue Submission
+	/*!
+		A group of consecutive tasks that are submitted to the same queue at once.
+	*/
+	struct QueueSubmission
+	{
+		SubmissionQueue m_queue = SubmissionQueue::DIRECT;
+		/*! The tasks in the submission in execution order. */
+		std::vector<std::uint32_t> m_tasks;
+		/*! Index of a submission on the other queue that has to finish before this submission starts. */
+		std::optional<std::uint32_t> m_wait_for = std::nullopt;
+		/*! Whether a fence has to be signaled after this submission because another submission waits for it. */
+		bool m_signal = false;
+	};
+
+	//! Queue Submission Plan
+	/*!
+		Result of `PlanQueueSubmissions`.
+		The submissions have to be submitted in order. A submission only waits for submissions that come before it.
+	*/
+	struct QueueSubmissionPlan
+	{
+		std::vector<QueueSubmission> m_submissions;
+		/*! The last compute submission the direct queue has to wait for before the frame ends. */
+		std::optional<std::uint32_t> m_wait_at_end = std::nullopt;
+		/*! Number of cross queue waits in the plan. */
+		std::uint32_t m_num_waits = 0u;
+	};
+
+	//! Split the tasks over the direct and compute queue.
+	/*!
+		Consecutive tasks on the same queue are grouped into a single submission.
+		A new submission is started when a task depends on work of the other queue that the queue didn't wait for yet.
+		Work on the same queue executes in order so only cross queue dependencies require a fence.
+		This is pure CPU code and doesn't depend on a render system.
+		\param queues The queue of every task, indexed by execution index.
+		\param dependencies The dependencies of every task, indexed by execution index. Dependencies have to execute earlier.
+	*/
+	WISPRENDERER_EXPORT QueueSubmissionPlan PlanQueueSubmissions(std::vector<SubmissionQueue> const & queues, std::vector<std::vector<std::uint32_t>> const & dependencies);
+
+} /* wr */
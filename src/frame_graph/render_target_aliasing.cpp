@@ -0,0 +1,106 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "render_target_aliasing.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace wr
+{
+
+	namespace internal
+	{
+
+		inline std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment)
+		{
+			return alignment > 1 ? (value + alignment - 1) & ~(alignment - 1) : value;
+		}
+
+		inline bool LifetimesOverlap(RenderTargetLifetime const & a, RenderTargetLifetime const & b)
+		{
+			return a.m_first_use <= b.m_last_use && b.m_first_use <= a.m_last_use;
+		}
+
+	} /* internal */
+
+	RenderTargetAliasingPlan PlanRenderTargetAliasing(std::vector<RenderTargetLifetime> const & lifetimes)
+	{
+		RenderTargetAliasingPlan plan;
+		plan.m_allocations.resize(lifetimes.size());
+
+		// Place the largest render targets first. This keeps the heap small for the typical
+		// case of a few full resolution targets and many smaller downscaled ones.
+		std::vector<std::size_t> order(lifetimes.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&lifetimes](std::size_t a, std::size_t b)
+		{
+			if (lifetimes[a].m_size_in_bytes != lifetimes[b].m_size_in_bytes)
+			{
+				return lifetimes[a].m_size_in_bytes > lifetimes[b].m_size_in_bytes;
+			}
+			return lifetimes[a].m_first_use < lifetimes[b].m_first_use;
+		});
+
+		std::vector<std::size_t> placed;
+		placed.reserve(lifetimes.size());
+
+		// Occupied [begin, end) ranges of render targets that are alive at the same time.
+		std::vector<std::pair<std::uint64_t, std::uint64_t>> occupied;
+		occupied.reserve(lifetimes.size());
+
+		for (auto idx : order)
+		{
+			auto const & lifetime = lifetimes[idx];
+
+			occupied.clear();
+			for (auto other : placed)
+			{
+				if (internal::LifetimesOverlap(lifetime, lifetimes[other]))
+				{
+					auto const & allocation = plan.m_allocations[other];
+					occupied.emplace_back(allocation.m_offset, allocation.m_offset + allocation.m_size_in_bytes);
+				}
+			}
+
+			std::sort(occupied.begin(), occupied.end());
+
+			// Find the first gap that is large enough.
+			std::uint64_t offset = 0;
+			for (auto const & range : occupied)
+			{
+				if (internal::AlignUp(offset, lifetime.m_alignment) + lifetime.m_size_in_bytes <= range.first)
+				{
+					break;
+				}
+				offset = std::max(offset, range.second);
+			}
+			offset = internal::AlignUp(offset, lifetime.m_alignment);
+
+			auto& allocation = plan.m_allocations[idx];
+			allocation.m_handle = lifetime.m_handle;
+			allocation.m_offset = offset;
+			allocation.m_size_in_bytes = lifetime.m_size_in_bytes;
+
+			plan.m_heap_size = std::max(plan.m_heap_size, offset + lifetime.m_size_in_bytes);
+			plan.m_unaliased_size += internal::AlignUp(lifetime.m_size_in_bytes, lifetime.m_alignment);
+
+			placed.push_back(idx);
+		}
+
+		return plan;
+	}
+
+} /* wr */
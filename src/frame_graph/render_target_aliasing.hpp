@@ -0,0 +1,70 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../wisprenderer_export.hpp"
+
+namespace wr
+{
+
+	/*! Describes when a render target is alive and how much memory it needs. */
+	struct RenderTargetLifetime
+	{
+		/*! The handle of the task that owns the render target. */
+		std::uint32_t m_handle = 0u;
+		std::uint64_t m_size_in_bytes = 0u;
+		std::uint64_t m_alignment = 1u;
+		/*! Execution index of the first and last task that use the render target. (Inclusive) */
+		std::uint32_t m_first_use = 0u;
+		std::uint32_t m_last_use = 0u;
+	};
+
+	/*! The location of a render target inside the shared heap. */
+	struct RenderTargetAllocation
+	{
+		std::uint32_t m_handle = 0u;
+		std::uint64_t m_offset = 0u;
+		std::uint64_t m_size_in_bytes = 0u;
+	};
+
+	//! Render Target Aliasing Plan
+	/*!
+		Result of `PlanRenderTargetAliasing`.
+		Render targets whose lifetimes don't overlap can share the same memory in the heap.
+	*/
+	struct RenderTargetAliasingPlan
+	{
+		/*! One allocation per lifetime passed to the planner, in the same order. */
+		std::vector<RenderTargetAllocation> m_allocations;
+		/*! Size of the heap required to hold all allocations. */
+		std::uint64_t m_heap_size = 0u;
+		/*! Memory the render targets would use without aliasing. */
+		std::uint64_t m_unaliased_size = 0u;
+	};
+
+	//! Pack render targets into a single heap.
+	/*!
+		Render targets are placed from large to small at the lowest offset that doesn't collide with
+		an already placed render target that is alive at the same time.
+		This is pure CPU code and doesn't depend on a render system.
+		\param lifetimes The render targets to place. Alignments should be a power of two.
+	*/
+	WISPRENDERER_EXPORT RenderTargetAliasingPlan PlanRenderTargetAliasing(std::vector<RenderTargetLifetime> const & lifetimes);
+
+} /* wr */
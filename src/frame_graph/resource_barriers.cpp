@@ -0,0 +1,190 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "resource_barriers.hpp"
+
+#include <algorithm>
+#include <optional>
+
+namespace wr
+{
+
+	namespace internal
+	{
+
+		inline bool IsReadOnlyState(std::uint32_t state, std::uint32_t read_only_states)
+		{
+			return state != 0u && (state & ~read_only_states) == 0u;
+		}
+
+		/*! Adds the barriers of a single resource to the plan. The usages are sorted by task. */
+		inline void PlanResourceBarriers(ResourceBarrierPlan& plan,
+			std::vector<ResourceUsage>::const_iterator begin,
+			std::vector<ResourceUsage>::const_iterator end,
+			std::optional<std::uint32_t> initial_state,
+			std::uint32_t read_only_states,
+			std::vector<SubmissionQueue> const & task_queues)
+		{
+			const auto resource = begin->m_resource;
+
+			// Combine the states a task declared for this resource.
+			std::vector<std::pair<std::uint32_t, std::uint32_t>> accesses; // task, state
+			for (auto it = begin; it != end; ++it)
+			{
+				if (accesses.empty() || accesses.back().first != it->m_task)
+				{
+					accesses.emplace_back(it->m_task, it->m_state);
+					continue;
+				}
+
+				auto& state = accesses.back().second;
+				if (IsReadOnlyState(state, read_only_states) && IsReadOnlyState(it->m_state, read_only_states))
+				{
+					state |= it->m_state;
+				}
+				else if (!IsReadOnlyState(it->m_state, read_only_states))
+				{
+					state = it->m_state;
+				}
+			}
+
+			// Count the barriers we would need without merging.
+			{
+				auto state = initial_state.value_or(accesses.front().second);
+				for (auto const & access : accesses)
+				{
+					plan.m_num_unmerged_barriers += access.second != state;
+					state = access.second;
+				}
+				plan.m_num_unmerged_barriers += accesses.back().second != initial_state.value_or(accesses.front().second);
+			}
+
+			// Merge runs of read-only usages into a single combined read state.
+			for (std::size_t i = 0; i < accesses.size();)
+			{
+				if (!IsReadOnlyState(accesses[i].second, read_only_states))
+				{
+					++i;
+					continue;
+				}
+
+				auto run_end = i;
+				std::uint32_t combined = 0u;
+				while (run_end < accesses.size() && IsReadOnlyState(accesses[run_end].second, read_only_states))
+				{
+					combined |= accesses[run_end].second;
+					++run_end;
+				}
+
+				for (; i < run_end; ++i)
+				{
+					accesses[i].second = combined;
+				}
+			}
+
+			const auto frame_state = initial_state.value_or(accesses.front().second);
+			auto state = frame_state;
+			std::optional<std::uint32_t> previous_task = std::nullopt;
+
+			for (auto const & access : accesses)
+			{
+				if (access.second != state)
+				{
+					ResourceBarrier barrier = { resource, state, access.second, ResourceBarrierSplit::NONE };
+
+					// Start the transition early when other tasks execute between the two usages.
+					// Split barriers can't cross queues.
+					const bool same_queue = task_queues.empty() || (previous_task.has_value() && task_queues[previous_task.value()] == task_queues[access.first]);
+					if (previous_task.has_value() && access.first > previous_task.value() + 1u && same_queue)
+					{
+						barrier.m_split = ResourceBarrierSplit::BEGIN;
+						plan.m_after[previous_task.value()].push_back(barrier);
+						barrier.m_split = ResourceBarrierSplit::END;
+					}
+
+					plan.m_before[access.first].push_back(barrier);
+					plan.m_num_barriers++;
+				}
+
+				state = access.second;
+				previous_task = access.first;
+			}
+
+			// Leave the resource in the state the next frame expects.
+			if (state != frame_state)
+			{
+				plan.m_after[previous_task.value()].push_back({ resource, state, frame_state, ResourceBarrierSplit::NONE });
+				plan.m_num_barriers++;
+			}
+		}
+
+	} /* internal */
+
+	ResourceBarrierPlan PlanResourceBarriers(std::uint32_t num_tasks,
+		std::vector<ResourceUsage> const & usages,
+		std::vector<ResourceInitialState> const & initial_states,
+		std::uint32_t read_only_states,
+		std::vector<SubmissionQueue> const & task_queues)
+	{
+		ResourceBarrierPlan plan;
+		plan.m_before.resize(num_tasks);
+		plan.m_after.resize(num_tasks);
+
+		// Group the usages by resource in execution order.
+		std::vector<ResourceUsage> sorted;
+		sorted.reserve(usages.size());
+		for (auto const & usage : usages)
+		{
+			if (usage.m_task < num_tasks)
+			{
+				sorted.push_back(usage);
+			}
+		}
+
+		std::stable_sort(sorted.begin(), sorted.end(), [](ResourceUsage const & a, ResourceUsage const & b)
+		{
+			if (a.m_resource != b.m_resource)
+			{
+				return a.m_resource < b.m_resource;
+			}
+			return a.m_task < b.m_task;
+		});
+
+		for (auto begin = sorted.cbegin(); begin != sorted.cend();)
+		{
+			auto end = std::find_if(begin, sorted.cend(), [begin](ResourceUsage const & usage)
+			{
+				return usage.m_resource != begin->m_resource;
+			});
+
+			std::optional<std::uint32_t> initial_state = std::nullopt;
+			auto initial_it = std::find_if(initial_states.begin(), initial_states.end(), [begin](ResourceInitialState const & initial)
+			{
+				return initial.m_resource == begin->m_resource;
+			});
+			if (initial_it != initial_states.end())
+			{
+				initial_state = initial_it->m_state;
+			}
+
+			internal::PlanResourceBarriers(plan, begin, end, initial_state, read_only_states, task_queues);
+
+			begin = end;
+		}
+
+		return plan;
+	}
+
+} /* wr */
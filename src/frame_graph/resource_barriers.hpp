@@ -0,0 +1,101 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../wisprenderer_export.hpp"
+#include "queue_submissions.hpp"
+
+namespace wr
+{
+
+	/*! Which half of a split barrier a barrier is. */
+	enum class ResourceBarrierSplit
+	{
+		NONE,
+		BEGIN,
+		END,
+	};
+
+	/*! A resource a task accesses and the state it has to be in while the task executes. */
+	struct ResourceUsage
+	{
+		/*! Execution index of the task. */
+		std::uint32_t m_task = 0u;
+		/*! Backend specific identifier of the resource. */
+		std::uint64_t m_resource = 0u;
+		/*! Backend specific state flags. */
+		std::uint32_t m_state = 0u;
+	};
+
+	/*! The state a resource is in at the start and end of a frame. */
+	struct ResourceInitialState
+	{
+		std::uint64_t m_resource = 0u;
+		std::uint32_t m_state = 0u;
+	};
+
+	/*! A single state transition of a resource. */
+	struct ResourceBarrier
+	{
+		std::uint64_t m_resource = 0u;
+		std::uint32_t m_from = 0u;
+		std::uint32_t m_to = 0u;
+		ResourceBarrierSplit m_split = ResourceBarrierSplit::NONE;
+	};
+
+	//! Resource Barrier Plan
+	/*!
+		Result of `PlanResourceBarriers`.
+		The barriers of a single list are meant to be recorded as one batch.
+	*/
+	struct ResourceBarrierPlan
+	{
+		/*! Barriers to record before a task executes, indexed by execution index. */
+		std::vector<std::vector<ResourceBarrier>> m_before;
+		/*! Barriers to record after a task executed, indexed by execution index. */
+		std::vector<std::vector<ResourceBarrier>> m_after;
+		/*! Number of barriers in the plan. A split barrier counts once. */
+		std::uint32_t m_num_barriers = 0u;
+		/*! Number of barriers needed when every usage is transitioned separately. */
+		std::uint32_t m_num_unmerged_barriers = 0u;
+	};
+
+	//! Calculate the transitions between tasks.
+	/*!
+		Consecutive read-only usages of a resource are merged into a single combined read state so a resource
+		isn't transitioned back and forth between read states. When a task declares multiple states for the same
+		resource the read states are combined. If one of them is a write state the write state is used.
+		When tasks that don't touch the resource execute between two usages on the same queue the transition is split:
+		it begins after the previous usage and ends before the next one.
+		At the end of the frame every resource is transitioned back to its initial state.
+		Resources without an initial state are assumed to start and end the frame in the state of their first usage.
+		This is pure CPU code and doesn't depend on a render system.
+		\param num_tasks The number of tasks that execute this frame.
+		\param usages The resource usages of all tasks.
+		\param initial_states The initial state of resources.
+		\param read_only_states Mask with all state flags that only read from a resource and can be combined.
+		\param task_queues The queue of every task, indexed by execution index. When empty all tasks are assumed to use the same queue.
+	*/
+	WISPRENDERER_EXPORT ResourceBarrierPlan PlanResourceBarriers(std::uint32_t num_tasks,
+		std::vector<ResourceUsage> const & usages,
+		std::vector<ResourceInitialState> const & initial_states,
+		std::uint32_t read_only_states,
+		std::vector<SubmissionQueue> const & task_queues = {});
+
+} /* wr */
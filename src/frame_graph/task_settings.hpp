@@ -0,0 +1,125 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "type_indices.hpp"
+
+namespace wr
+{
+
+	namespace internal
+	{
+		/*! Get the unique index of a settings type. Used to check the type of the settings without a `dynamic_cast`. */
+		/*!
+			Settings created in the executable are read by tasks in the library, so the index comes from the registry in the library.
+		*/
+		template<typename T>
+		inline std::uint32_t GetTaskSettingsTypeIndex()
+		{
+			static const std::uint32_t index = RegisterTypeIndex(TypeIndexRegistry::TASK_SETTINGS, typeid(T));
+			return index;
+		}
+	} /* internal */
+
+	//! Type independent base of `TaskSettings`.
+	class TaskSettingsBase
+	{
+	public:
+		explicit TaskSettingsBase(std::uint32_t type_index) : m_type_index(type_index)
+		{
+		}
+
+		virtual ~TaskSettingsBase() = default;
+
+		TaskSettingsBase(TaskSettingsBase const &) = delete;
+		TaskSettingsBase& operator=(TaskSettingsBase const &) = delete;
+
+		/*! Make the latest published settings the current settings. Returns whether the settings changed. */
+		virtual bool Acquire() = 0;
+
+		std::uint32_t GetTypeIndex() const
+		{
+			return m_type_index;
+		}
+
+	private:
+		const std::uint32_t m_type_index;
+	};
+
+	//! Buffered settings of a render task.
+	/*!
+		The settings are stored in three slots so a writer can publish new settings while the tasks read the current settings without locking.
+		The writer fills its back slot and swaps it with the pending slot.
+		At the start of a frame the frame graph swaps the pending slot with the current slot if new settings were published.
+		The current slot doesn't change while the tasks are executing so every task sees the same settings during a frame.
+		Only one thread at a time is allowed to publish settings.
+		\tparam T The type of the settings. Has to be copy assignable.
+	*/
+	template<typename T>
+	class TaskSettings : public TaskSettingsBase
+	{
+		static constexpr std::uint8_t index_mask = 0x3;
+		static constexpr std::uint8_t dirty_bit = 0x4;
+
+	public:
+		explicit TaskSettings(T const & settings) :
+			TaskSettingsBase(internal::GetTaskSettingsTypeIndex<T>()),
+			m_slots({ settings, settings, settings }),
+			m_pending(1),
+			m_front(0),
+			m_back(2)
+		{
+		}
+
+		/*! Publish new settings. They become the current settings at the next call to `Acquire`. */
+		void Publish(T const & settings)
+		{
+			m_slots[m_back] = settings;
+			m_back = m_pending.exchange(m_back | dirty_bit, std::memory_order_acq_rel) & index_mask;
+		}
+
+		bool Acquire() final
+		{
+			if (!(m_pending.load(std::memory_order_relaxed) & dirty_bit))
+			{
+				return false;
+			}
+
+			m_front = m_pending.exchange(m_front, std::memory_order_acq_rel) & index_mask;
+			return true;
+		}
+
+		/*! The current settings. */
+		T const & Get() const
+		{
+			return m_slots[m_front];
+		}
+
+	private:
+		std::array<T, 3> m_slots;
+		/*! Index of the slot with the latest published settings. Contains `dirty_bit` when it wasn't acquired yet. */
+		std::atomic<std::uint8_t> m_pending;
+		/*! Index of the slot the tasks read from. Only changed by `Acquire`. */
+		std::uint8_t m_front;
+		/*! Index of the slot the writer fills. Only changed by `Publish`. */
+		std::uint8_t m_back;
+	};
+
+} /* wr */
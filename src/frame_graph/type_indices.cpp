@@ -0,0 +1,41 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "type_indices.hpp"
+
+#include <array>
+#include <mutex>
+#include <unordered_map>
+
+namespace wr
+{
+
+	namespace internal
+	{
+
+		std::uint32_t RegisterTypeIndex(TypeIndexRegistry registry, std::type_index type)
+		{
+			static std::mutex mutex;
+			static std::array<std::unordered_map<std::type_index, std::uint32_t>, static_cast<std::size_t>(TypeIndexRegistry::COUNT)> indices;
+
+			std::lock_guard<std::mutex> lock(mutex);
+
+			auto& registry_indices = indices[static_cast<std::size_t>(registry)];
+			return registry_indices.emplace(type, static_cast<std::uint32_t>(registry_indices.size())).first->second;
+		}
+
+	} /* internal */
+
+} /* wr */
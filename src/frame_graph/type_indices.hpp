@@ -0,0 +1,47 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <typeindex>
+
+#include "../wisprenderer_export.hpp"
+
+namespace wr
+{
+
+	namespace internal
+	{
+		/*! The registries that hand out type indices. Every registry counts from zero. */
+		enum class TypeIndexRegistry : std::uint8_t
+		{
+			FRAME_GRAPH_TASK,
+			TASK_SETTINGS,
+			COUNT
+		};
+
+		/*! Get the index of a type in a registry, giving the type the next free index the first time. */
+		/*!
+			The registry lives in the renderer library and is keyed on `std::type_index`.
+			When the renderer is built as a shared library every module has its own copy of inline variables and function-local statics,
+			so a counter in a header would give the same type a different index in the executable and in the library.
+			Thread-safe. Callers cache the result, see `GetFrameGraphTypeIndex` and `GetTaskSettingsTypeIndex`.
+		*/
+		WISPRENDERER_EXPORT std::uint32_t RegisterTypeIndex(TypeIndexRegistry registry, std::type_index type);
+
+	} /* internal */
+
+} /* wr */
@@ -18,6 +18,7 @@
 #include "imgui/imgui_internal.hpp"
 
 #include <sstream>
+#include <algorithm>
 #include <optional>
 #include <filesystem>
 
@@ -31,6 +32,8 @@
 #include "scene_graph/mesh_node.hpp"
 #include "scene_graph/skybox_node.hpp"
 #include "model_pool.hpp"
+#include "frame_graph/frame_graph_profiler.hpp"
+#include "util/thread_pool.hpp"
 #include "shader_registry.hpp"
 #include "rt_pipeline_registry.hpp"
 #include "pipeline_registry.hpp"
@@ -598,6 +601,142 @@ namespace wr::imgui::window
 		}
 	}
 
+	void FrameGraphTimings(FrameGraphProfiler const & profiler)
+	{
+		if (open_frame_graph_timings)
+		{
+			// The current frame is still being recorded so show the previous one.
+			const auto current_frame = profiler.GetFrame();
+			const auto frame = current_frame > 0 ? current_frame - 1 : 0;
+			const auto stats = profiler.GetFrameStats(frame);
+			auto const & names = profiler.GetTaskNames();
+
+			ImGui::Begin("Frame Graph Timings", &open_frame_graph_timings);
+
+			ImGui::Text("Frame: %llu", stats.m_frame);
+			ImGui::Text("Execute Time: %.3f ms", stats.m_frame_ms);
+			ImGui::Text("Critical Path: %.3f ms", stats.m_critical_path_ms);
+
+			if (ImGui::Button("Save Chrome Trace"))
+			{
+				profiler.SaveChromeTrace("frame_graph_trace.json");
+			}
+
+			ImGui::Separator();
+
+			if (ImGui::CollapsingHeader("Critical Path", ImGuiTreeNodeFlags_DefaultOpen))
+			{
+				for (auto task : stats.m_critical_path)
+				{
+					if (task < names.size())
+					{
+						ImGui::BulletText("%s (%.3f ms)", names[task].c_str(), stats.m_tasks[task].m_execute_ms - stats.m_tasks[task].m_wait_ms);
+					}
+				}
+			}
+
+			if (ImGui::CollapsingHeader("Tasks", ImGuiTreeNodeFlags_DefaultOpen))
+			{
+				ImGui::Columns(4, "frame_graph_timings");
+				ImGui::Text("Task"); ImGui::NextColumn();
+				ImGui::Text("Setup (ms)"); ImGui::NextColumn();
+				ImGui::Text("Execute (ms)"); ImGui::NextColumn();
+				ImGui::Text("Wait (ms)"); ImGui::NextColumn();
+				ImGui::Separator();
+
+				for (std::size_t i = 0; i < stats.m_tasks.size() && i < names.size(); ++i)
+				{
+					auto const & task = stats.m_tasks[i];
+					const bool critical = std::find(stats.m_critical_path.begin(), stats.m_critical_path.end(), static_cast<std::uint32_t>(i)) != stats.m_critical_path.end();
+
+					if (critical)
+					{
+						ImGui::TextColored(ImVec4(1.f, 0.5f, 0.f, 1.f), "%s", names[i].c_str());
+					}
+					else
+					{
+						ImGui::Text("%s", names[i].c_str());
+					}
+					ImGui::NextColumn();
+
+					ImGui::Text("%.3f", task.m_setup_ms); ImGui::NextColumn();
+					ImGui::Text("%.3f", task.m_execute_ms); ImGui::NextColumn();
+					ImGui::Text("%.3f", task.m_wait_ms); ImGui::NextColumn();
+				}
+
+				ImGui::Columns(1);
+			}
+
+			ImGui::End();
+		}
+	}
+
+	void ThreadPoolTelemetry(util::ThreadPoolStats const & stats)
+	{
+		if (open_thread_pool_telemetry)
+		{
+			static const char* lane_names[] = { "Frame Critical", "Background" };
+
+			ImGui::Begin("Thread Pool Telemetry", &open_thread_pool_telemetry);
+
+			ImGui::Text("Threads: %zu", stats.m_workers.size());
+			ImGui::Text("Uptime: %.1f s", stats.m_uptime_ms / 1000.0);
+
+			if (ImGui::CollapsingHeader("Lanes", ImGuiTreeNodeFlags_DefaultOpen))
+			{
+				ImGui::Columns(6, "thread_pool_lanes");
+				ImGui::Text("Lane"); ImGui::NextColumn();
+				ImGui::Text("Queued"); ImGui::NextColumn();
+				ImGui::Text("Max Queued"); ImGui::NextColumn();
+				ImGui::Text("Completed"); ImGui::NextColumn();
+				ImGui::Text("Avg Latency (ms)"); ImGui::NextColumn();
+				ImGui::Text("Max Latency (ms)"); ImGui::NextColumn();
+				ImGui::Separator();
+
+				for (std::size_t i = 0; i < stats.m_lanes.size(); ++i)
+				{
+					auto const & lane = stats.m_lanes[i];
+
+					ImGui::Text("%s", lane_names[i]); ImGui::NextColumn();
+					ImGui::Text("%u", lane.m_num_queued); ImGui::NextColumn();
+					ImGui::Text("%u", lane.m_max_queued); ImGui::NextColumn();
+					ImGui::Text("%llu", lane.m_num_completed); ImGui::NextColumn();
+					ImGui::Text("%.3f", lane.m_average_latency_ms); ImGui::NextColumn();
+					ImGui::Text("%.3f", lane.m_max_latency_ms); ImGui::NextColumn();
+				}
+
+				ImGui::Columns(1);
+			}
+
+			if (ImGui::CollapsingHeader("Workers", ImGuiTreeNodeFlags_DefaultOpen))
+			{
+				ImGui::Columns(5, "thread_pool_workers");
+				ImGui::Text("Worker"); ImGui::NextColumn();
+				ImGui::Text("Tasks"); ImGui::NextColumn();
+				ImGui::Text("Steals"); ImGui::NextColumn();
+				ImGui::Text("Busy (ms)"); ImGui::NextColumn();
+				ImGui::Text("Utilization"); ImGui::NextColumn();
+				ImGui::Separator();
+
+				for (std::size_t i = 0; i < stats.m_workers.size(); ++i)
+				{
+					auto const & worker = stats.m_workers[i];
+					const auto total_ms = worker.m_busy_ms + worker.m_idle_ms;
+
+					ImGui::Text("%zu", i); ImGui::NextColumn();
+					ImGui::Text("%llu", worker.m_num_tasks); ImGui::NextColumn();
+					ImGui::Text("%llu", worker.m_num_steals); ImGui::NextColumn();
+					ImGui::Text("%.1f", worker.m_busy_ms); ImGui::NextColumn();
+					ImGui::ProgressBar(total_ms > 0.0 ? static_cast<float>(worker.m_busy_ms / total_ms) : 0.f); ImGui::NextColumn();
+				}
+
+				ImGui::Columns(1);
+			}
+
+			ImGui::End();
+		}
+	}
+
 	void ShaderRegistry()
 	{
 		if (open_shader_registry)
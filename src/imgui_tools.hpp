@@ -27,6 +27,12 @@ namespace wr
 {
 	class D3D12RenderSystem;
 	class SceneGraph;
+	class FrameGraphProfiler;
+}
+
+namespace util
+{
+	struct ThreadPoolStats;
 }
 
 namespace wr::imgui
@@ -52,6 +58,8 @@ namespace wr::imgui
 		void D3D12Settings();
 		void SceneGraphEditor(SceneGraph* scene_graph);
 		void Inspector(SceneGraph* scene_graph, ImVec2 viewport_pos, ImVec2 viewport_size);
+		void FrameGraphTimings(FrameGraphProfiler const & profiler);
+		void ThreadPoolTelemetry(util::ThreadPoolStats const & stats);
 
 		static bool open_hardware_info = true;
 		static bool open_d3d12_settings = true;
@@ -62,6 +70,8 @@ namespace wr::imgui
 		static bool open_root_signature_registry = false;
 		static bool open_scene_graph_editor = true;
 		static bool open_inspector = true;
+		static bool open_frame_graph_timings = false;
+		static bool open_thread_pool_telemetry = false;
 		static wr::LightNode* selected_light = nullptr;
 		static bool light_selected = false;
 
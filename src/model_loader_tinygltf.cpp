@@ -16,6 +16,7 @@
 #include "model_loader_tinygltf.hpp"
 
 #include "util/log.hpp"
+#include "util/parallel.hpp"
 
 #define TINYGLTF_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -46,11 +47,16 @@ namespace wr
 		}
 
 		// (1)
-		size_t indexCount = mesh_data->m_indices.size();
-		for (size_t i = 0; i < mesh_data->m_indices.size(); i += 3) {
-			size_t i0 = mesh_data->m_indices[i];
-			size_t i1 = mesh_data->m_indices[i + 1];
-			size_t i2 = mesh_data->m_indices[i + 2];
+		// The triangles are solved in parallel. Vertices shared between triangles keep the value of the last triangle,
+		// so the results are written back serially in index order.
+		const size_t triangle_count = mesh_data->m_indices.size() / 3;
+		std::vector<std::pair<DirectX::XMFLOAT3, DirectX::XMFLOAT3>> triangle_tangents(triangle_count);
+
+		util::ParallelFor(0, triangle_count, 1024, [mesh_data, &triangle_tangents](size_t triangle)
+		{
+			size_t i0 = mesh_data->m_indices[triangle * 3];
+			size_t i1 = mesh_data->m_indices[triangle * 3 + 1];
+			size_t i2 = mesh_data->m_indices[triangle * 3 + 2];
 
 			auto pos0 = DirectX::XMLoadFloat3(&mesh_data->m_positions[i0]);
 			auto pos1 = DirectX::XMLoadFloat3(&mesh_data->m_positions[i1]);
@@ -82,14 +88,19 @@ namespace wr
 				((edge1.z * uv2.x) - (edge2.z * uv1.x)) * r
 			);
 
-			tanA[i0] = tangent;
-			tanA[i1] = tangent;
-			tanA[i2] = tangent;
+			triangle_tangents[triangle] = { tangent, bitangent };
+		});
 
-			tanB[i0] = bitangent;
-			tanB[i1] = bitangent;
-			tanB[i2] = bitangent;
+		for (size_t triangle = 0; triangle < triangle_count; ++triangle)
+		{
+			auto& [tangent, bitangent] = triangle_tangents[triangle];
 
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				size_t index = mesh_data->m_indices[triangle * 3 + corner];
+				tanA[index] = tangent;
+				tanB[index] = bitangent;
+			}
 		}
 
 		return { tanA, tanB };
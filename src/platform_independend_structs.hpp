@@ -59,6 +59,12 @@ namespace wr
 		ResolutionScalar m_resolution_scale = ResolutionScalar(1.0f);
 	};
 
+	struct RenderTargetAllocationInfo
+	{
+		std::uint64_t m_size_in_bytes = 0u;
+		std::uint64_t m_alignment = 1u;
+	};
+
 	enum class LightType : int
 	{
 		POINT, DIRECTIONAL, SPOT, FREE
@@ -223,7 +223,7 @@ namespace wr
 		desc.m_type = RenderTaskType::COMPUTE;
 		desc.m_allow_multithreading = true;
 
-		frame_graph.AddTask<BloomCompostionData>(desc, L"Bloom Composition");
+		frame_graph.AddTask<BloomCompostionData>(desc, L"Bloom Composition", FG_DEPS<T, T1>());
 		frame_graph.UpdateSettings<BloomCompostionData>(BloomSettings());
 	}
 
@@ -200,7 +200,7 @@ namespace wr
 		desc.m_type = RenderTaskType::COMPUTE;
 		desc.m_allow_multithreading = true;
 
-		frame_graph.AddTask<BloomExtractBrightData>(desc, L"extract bright");
+		frame_graph.AddTask<BloomExtractBrightData>(desc, L"extract bright", FG_DEPS<T, T1>());
 	}
 
 } /* wr */
@@ -79,9 +79,23 @@ namespace wr
 				d3d12::Transition(cmd_list, brdf_lut, ResourceState::UNORDERED_ACCESS, ResourceState::PIXEL_SHADER_RESOURCE);
 
 				n_render_system.m_brdf_lut_generated = true;
-				fg.SetShouldExecute(handle, false);
 			}
 		}
+
+		inline std::uint64_t GetBrdfLutPrecalculationFingerprint(RenderSystem& rs, FrameGraph&, SceneGraph&, RenderTaskHandle)
+		{
+			auto& n_render_system = static_cast<D3D12RenderSystem&>(rs);
+
+			// The LUT only depends on the texture it is written to.
+			std::uint64_t fingerprint = 0;
+			if (n_render_system.m_brdf_lut.has_value())
+			{
+				fingerprint = util::HashCombine(fingerprint, n_render_system.m_brdf_lut.value().m_pool);
+				fingerprint = util::HashCombine(fingerprint, n_render_system.m_brdf_lut.value().m_id);
+			}
+
+			return fingerprint;
+		}
 	}
 
 	inline void AddBrdfLutPrecalculationTask(FrameGraph& fg)
@@ -95,10 +109,14 @@ namespace wr
 		};
 		desc.m_destroy_func = [](FrameGraph&, RenderTaskHandle, bool) {
 		};
+		desc.m_fingerprint_func = [](RenderSystem& rs, FrameGraph& fg, SceneGraph& sg, RenderTaskHandle handle) {
+			return internal::GetBrdfLutPrecalculationFingerprint(rs, fg, sg, handle);
+		};
 
 		desc.m_properties = std::nullopt;
 		desc.m_type = RenderTaskType::COMPUTE;
 		desc.m_allow_multithreading = true;
+		desc.m_resolution_dependent = false;
 
 		fg.AddTask<BrdfLutTaskData>(desc, L"BRDF LUT Precalculation");
 	}
@@ -25,6 +25,7 @@
 
 #include "../render_tasks/d3d12_deferred_main.hpp"
 #include "../imgui_tools.hpp"
+#include "../util/parallel.hpp"
 
 namespace wr
 {
@@ -378,6 +379,17 @@ namespace wr
 
 				unsigned int offset_id = 0;
 
+				struct InstanceRange
+				{
+					d3d12::AccelerationStructure m_blas;
+					std::uint64_t m_material;
+					std::vector<temp::ObjectData> const * m_objects;
+					std::size_t m_first;
+					std::size_t m_count;
+				};
+				std::vector<InstanceRange> instance_ranges;
+				std::size_t num_instances = 0;
+
 				//ReconstructBLASsIfNeeded(device, cmd_list, scene_graph, data);
 
 				// Update transformations // TODO: This might be unnessessary if reconstrblasifneeded return true.
@@ -435,18 +447,25 @@ namespace wr
 
 						assert(it != batchInfo.end() && "Batch was found in global array, but not in local");
 
-						// Push instances into a array for later use.
-						for (uint32_t i = 0U, j = (uint32_t)it->second.num_global_instances; i < j; i++)
-						{
-							auto transform = batch.second[i].m_model;
-
-							data.out_blas_list.push_back({ blas, offset_id, transform });
-						}
+						// Remember where the instances go. They're gathered in parallel below.
+						instance_ranges.push_back({ blas, offset_id, &batch.second, num_instances, it->second.num_global_instances });
+						num_instances += it->second.num_global_instances;
 
 						offset_id++;
 					}
 				}
 
+				// Push instances into a array for later use.
+				data.out_blas_list.resize(num_instances);
+				util::ParallelFor(0, instance_ranges.size(), 16, [&](std::size_t range_i)
+				{
+					auto& range = instance_ranges[range_i];
+					for (std::size_t i = 0; i < range.m_count; i++)
+					{
+						data.out_blas_list[range.m_first + i] = { range.m_blas, range.m_material, (*range.m_objects)[i].m_model };
+					}
+				});
+
 				d3d12::AccelerationStructure old_accel = data.out_tlas;
 				d3d12::UpdateTopLevelAccelerationStructure(data.out_tlas, device, cmd_list, out_heap, data.out_blas_list, frame_idx);
 
@@ -564,6 +583,7 @@ namespace wr
 		desc.m_properties = rt_properties;
 		desc.m_type = RenderTaskType::COMPUTE;
 		desc.m_allow_multithreading = true;
+		desc.m_resolution_dependent = false;
 
 		frame_graph.AddTask<ASBuildData>(desc, L"Acceleration Structure Builder");
 		frame_graph.UpdateSettings<ASBuildData>(ASBuildSettings());
@@ -208,11 +208,32 @@ namespace wr
 					//Mark for unload makes the m_hdr handle invalid, if it's used anywhere else the program will probably break.
 					//If users want to keep using the equirectangular texture afterward, the following line of code can be removed.
 					skybox_node->m_hdr.m_pool->MarkForUnload(skybox_node->m_hdr, frame_idx);
-
-					fg.SetShouldExecute(handle, false);
 				}
 			}
-			//if (data.should_run)
+			else
+			{
+				// The cubemap isn't staged yet. Try again next frame.
+				fg.InvalidateFingerprint(handle);
+			}
+		}
+
+		inline std::uint64_t GetCubemapConvolutionFingerprint(RenderSystem&, FrameGraph& fg, SceneGraph& scene_graph, RenderTaskHandle handle)
+		{
+			auto skybox_node = scene_graph.GetCurrentSkybox();
+			if (!skybox_node)
+			{
+				return 0;
+			}
+
+			auto settings = fg.GetSettings<CubemapConvolutionSettings>(handle);
+
+			// The convolution runs again when the current skybox or the resolution changes.
+			// Like the equirect to cubemap task the textures are left out since executing the tasks creates them.
+			std::uint64_t fingerprint = util::HashCombine(0, skybox_node.get());
+			fingerprint = util::HashCombine(fingerprint, settings.m_runtime.m_resolution[0]);
+			fingerprint = util::HashCombine(fingerprint, settings.m_runtime.m_resolution[1]);
+
+			return fingerprint;
 		}
 
 	} /* internal */
@@ -243,10 +264,14 @@ namespace wr
 		};
 		desc.m_destroy_func = [](FrameGraph& fg, RenderTaskHandle handle, bool resize) {
 		};
+		desc.m_fingerprint_func = [](RenderSystem& rs, FrameGraph& fg, SceneGraph& sg, RenderTaskHandle handle) {
+			return internal::GetCubemapConvolutionFingerprint(rs, fg, sg, handle);
+		};
 
 		desc.m_properties = rt_properties;
 		desc.m_type = RenderTaskType::DIRECT;
 		desc.m_allow_multithreading = true;
+		desc.m_resolution_dependent = false;
 
 		fg.AddTask<CubemapConvolutionTaskData>(desc, L"Cubemap Convolution");
 		fg.UpdateSettings<CubemapConvolutionTaskData>(CubemapConvolutionSettings());
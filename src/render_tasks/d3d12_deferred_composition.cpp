@@ -257,7 +257,11 @@ namespace wr
 				const auto frame_idx = n_render_system.GetFrameIdx();
 
 				// Update camera constant buffer pool
-				auto active_camera = scene_graph.GetActiveCamera();
+				auto active_camera = fg.GetViewCamera(handle);
+				if (!active_camera)
+				{
+					active_camera = scene_graph.GetActiveCamera();
+				}
 
 				temp::ProjectionView_CBData camera_data{};
 				camera_data.m_projection = active_camera->m_projection;
@@ -67,10 +67,32 @@ namespace wr
 				d3d12::BindPipeline(cmd_list, data.in_pipeline);
 				d3d12::SetPrimitiveTopology(cmd_list, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
-				auto d3d12_cb_handle = static_cast<D3D12ConstantBufferHandle*>(scene_graph.GetActiveCamera()->m_camera_cb);
+				// Tasks added with `FrameGraph::ForView` render the camera of their view.
+				auto view_camera = fg.GetViewCamera(handle);
+				auto camera = view_camera ? view_camera.get() : scene_graph.GetActiveCamera().get();
+
+				auto d3d12_cb_handle = static_cast<D3D12ConstantBufferHandle*>(camera->m_camera_cb);
 				d3d12::BindConstantBuffer(cmd_list, d3d12_cb_handle->m_native, 0, frame_idx);
 
-				scene_graph.Render(cmd_list, scene_graph.GetActiveCamera().get());
+				if constexpr (d3d12::settings::num_deferred_main_cmd_lists == 0)
+				{
+					scene_graph.Render(cmd_list, camera);
+				}
+				else
+				{
+					// The secondary command lists don't inherit the state bound above.
+					fg.RecordParallel(handle, scene_graph.GetBatches().size(), [&scene_graph, &data, viewport, frame_idx, d3d12_cb_handle, camera](CommandList* secondary_cmd_list, std::size_t first_batch, std::size_t num_batches)
+					{
+						auto n_cmd_list = static_cast<d3d12::CommandList*>(secondary_cmd_list);
+
+						d3d12::BindViewport(n_cmd_list, viewport);
+						d3d12::BindPipeline(n_cmd_list, data.in_pipeline);
+						d3d12::SetPrimitiveTopology(n_cmd_list, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+						d3d12::BindConstantBuffer(n_cmd_list, d3d12_cb_handle->m_native, 0, frame_idx);
+
+						scene_graph.Render(secondary_cmd_list, camera, first_batch, num_batches);
+					});
+				}
 			}
 		}
 
@@ -124,6 +146,7 @@ namespace wr
 		desc.m_properties = is_hybrid ? rt_properties_hybrid : rt_properties_deferred;
 		desc.m_type = RenderTaskType::DIRECT;
 		desc.m_allow_multithreading = true;
+		desc.m_num_secondary_cmd_lists = d3d12::settings::num_deferred_main_cmd_lists;
 
 		fg.AddTask<DeferredMainTaskData>(desc, L"Deferred Main");
 	}
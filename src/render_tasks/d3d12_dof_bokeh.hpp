@@ -250,7 +250,7 @@ namespace wr
 		desc.m_type = RenderTaskType::COMPUTE;
 		desc.m_allow_multithreading = true;
 
-		frame_graph.AddTask<DoFBokehData>(desc, L"DoF Bokeh Pass");
+		frame_graph.AddTask<DoFBokehData>(desc, L"DoF Bokeh Pass", FG_DEPS<T, T1>());
 	}
 
 } /* wr */
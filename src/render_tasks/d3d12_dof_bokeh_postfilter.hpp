@@ -191,7 +191,7 @@ namespace wr
 		desc.m_type = RenderTaskType::COMPUTE;
 		desc.m_allow_multithreading = true;
 
-		frame_graph.AddTask<DoFBokehPostFilterData>(desc, L"DoF Bokeh Post Filter");
+		frame_graph.AddTask<DoFBokehPostFilterData>(desc, L"DoF Bokeh Post Filter", FG_DEPS<T>());
 	}
 
 } /* wr */
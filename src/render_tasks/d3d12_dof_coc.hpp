@@ -198,7 +198,7 @@ namespace wr
 		desc.m_type = RenderTaskType::COMPUTE;
 		desc.m_allow_multithreading = true;
 
-		frame_graph.AddTask<DoFCoCData>(desc, L"DoF Cone of Confusion");
+		frame_graph.AddTask<DoFCoCData>(desc, L"DoF Cone of Confusion", FG_DEPS<T>());
 	}
 
 } /* wr */
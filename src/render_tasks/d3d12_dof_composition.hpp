@@ -217,7 +217,7 @@ namespace wr
 		desc.m_type = RenderTaskType::COMPUTE;
 		desc.m_allow_multithreading = true;
 
-		frame_graph.AddTask<DoFCompositionData>(desc, L"DoF Composition");
+		frame_graph.AddTask<DoFCompositionData>(desc, L"DoF Composition", FG_DEPS<T, T1, T2>());
 	}
 
 } /* wr */
@@ -172,7 +172,7 @@ namespace wr
 		desc.m_type = RenderTaskType::COMPUTE;
 		desc.m_allow_multithreading = true;
 
-		frame_graph.AddTask<DoFNearMaskData>(desc, L"DoF near mask");
+		frame_graph.AddTask<DoFNearMaskData>(desc, L"DoF near mask", FG_DEPS<T>());
 	}
 
 } /* wr */
@@ -160,7 +160,7 @@ namespace wr
 		desc.m_type = RenderTaskType::COMPUTE;
 		desc.m_allow_multithreading = true;
 
-		frame_graph.AddTask<DoFDilateFlattenData>(desc, L"DoF coc dilate flatten horizontal");
+		frame_graph.AddTask<DoFDilateFlattenData>(desc, L"DoF coc dilate flatten horizontal", FG_DEPS<T>());
 	}
 
 } /* wr */
@@ -161,7 +161,7 @@ namespace wr
 		desc.m_type = RenderTaskType::COMPUTE;
 		desc.m_allow_multithreading = true;
 
-		frame_graph.AddTask<DoFDilateFlattenHData>(desc, L"DoF dilate flatten vertical pass");
+		frame_graph.AddTask<DoFDilateFlattenHData>(desc, L"DoF dilate flatten vertical pass", FG_DEPS<T>());
 	}
 
 } /* wr */
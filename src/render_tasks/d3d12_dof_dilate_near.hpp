@@ -160,7 +160,7 @@ namespace wr
 		desc.m_type = RenderTaskType::COMPUTE;
 		desc.m_allow_multithreading = true;
 
-		frame_graph.AddTask<DoFDilateData>(desc, L"DoF Dilate");
+		frame_graph.AddTask<DoFDilateData>(desc, L"DoF Dilate", FG_DEPS<T>());
 	}
 
 } /* wr */
@@ -290,9 +290,21 @@ namespace wr
 
 				//Prefilter environment map
 				PrefilterCubemap(cmd_list, data.out_cubemap, data.out_pref_env);
+			}
+		}
 
-				fg.SetShouldExecute(handle, false);
+		inline std::uint64_t GetEquirectToCubemapFingerprint(RenderSystem&, FrameGraph&, SceneGraph& scene_graph, RenderTaskHandle)
+		{
+			auto skybox_node = scene_graph.GetCurrentSkybox();
+			if (!skybox_node)
+			{
+				return 0;
 			}
+
+			// The conversion runs again when the current skybox changes.
+			// The textures of the node are left out, executing the task creates the cubemaps and the convolution unloads the equirectangular texture.
+			// `RenderSystem::RequestSkyboxReload` invalidates the fingerprint when the node gets a new texture.
+			return util::HashCombine(0, skybox_node.get());
 		}
 
 	} /* internal */
@@ -328,10 +340,14 @@ namespace wr
 				data.camera_cb_pool.reset();
 			}
 		};
+		desc.m_fingerprint_func = [](RenderSystem& rs, FrameGraph& fg, SceneGraph& sg, RenderTaskHandle handle) {
+			return internal::GetEquirectToCubemapFingerprint(rs, fg, sg, handle);
+		};
 
 		desc.m_properties = rt_properties;
 		desc.m_type = RenderTaskType::DIRECT;
 		desc.m_allow_multithreading = true;
+		desc.m_resolution_dependent = false;
 
 		fg.AddTask<EquirectToCubemapTaskData>(desc, L"Equire To Cubemap");
 	}
@@ -160,7 +160,7 @@ namespace wr
 		desc.m_type = RenderTaskType::COMPUTE;
 		desc.m_allow_multithreading = true;
 
-		frame_graph.AddTask<PostProcessingData>(desc, L"Post Processing");
+		frame_graph.AddTask<PostProcessingData>(desc, L"Post Processing", FG_DEPS<T>());
 	}
 
 } /* wr */
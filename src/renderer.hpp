@@ -22,6 +22,7 @@
 #include "engine_registry.hpp"
 #include "platform_independend_structs.hpp"
 #include "structs.hpp"
+#include "frame_graph/resource_barriers.hpp"
 
 namespace wr
 {
@@ -74,6 +75,7 @@ namespace wr
 		virtual void SetCommandListName(CommandList* cmd_list, std::wstring const & name) = 0;
 		virtual void DestroyCommandList(CommandList* cmd_list) = 0;
 		virtual RenderTarget* GetRenderTarget(RenderTargetProperties properties) = 0;
+		virtual RenderTargetAllocationInfo GetRenderTargetAllocationInfo(RenderTargetProperties properties) = 0;
 		virtual void SetRenderTargetName(RenderTarget* cmd_list, std::wstring const & name) = 0;
 		virtual void ResizeRenderTarget(RenderTarget** render_target, std::uint32_t width, std::uint32_t height) = 0;
 		virtual void DestroyRenderTarget(RenderTarget** render_target) = 0;
@@ -82,10 +84,12 @@ namespace wr
 		virtual void CloseCommandList(CommandList* cmd_list) = 0;
 		virtual void StartRenderTask(CommandList* cmd_list, std::pair<RenderTarget*, RenderTargetProperties> render_target) = 0;
 		virtual void StopRenderTask(CommandList* cmd_list, std::pair<RenderTarget*, RenderTargetProperties> render_target) = 0;
+		virtual void ContinueRenderTask(CommandList* cmd_list, std::pair<RenderTarget*, RenderTargetProperties> render_target) = 0;
 		virtual void StartComputeTask(CommandList* cmd_list, std::pair<RenderTarget*, RenderTargetProperties> render_target) = 0;
 		virtual void StopComputeTask(CommandList* cmd_list, std::pair<RenderTarget*, RenderTargetProperties> render_target) = 0;
 		virtual void StartCopyTask(CommandList* cmd_list, std::pair<RenderTarget*, RenderTargetProperties> render_target) = 0;
 		virtual void StopCopyTask(CommandList* cmd_list, std::pair<RenderTarget*, RenderTargetProperties> render_target) = 0;
+		virtual void RecordResourceBarriers(CommandList* cmd_list, std::vector<ResourceBarrier> const & barriers) = 0;
 
 		virtual void Init(std::optional<Window*> window) = 0;
 		virtual CPUTextures Render(SceneGraph & scene_graph, FrameGraph & frame_graph) = 0;
@@ -15,10 +15,20 @@
  */
 #include "node.hpp"
 
+#include "transform_store.hpp"
 #include "../util/log.hpp"
 
+#include <algorithm>
+#include <atomic>
+
 namespace wr
 {
+	namespace internal
+	{
+		//! Generations only ever increase, so a node is outdated when any parent has a newer one.
+		static std::atomic<std::uint64_t> transform_generation = 0;
+	} /* internal */
+
 	Node::Node() : m_type_info(typeid(Node))
 	{
 		SignalTransformChange();
@@ -36,11 +46,11 @@ namespace wr
 
 	void Node::SignalTransformChange()
 	{
-		m_requires_transform_update[0] = m_requires_transform_update[1] = m_requires_transform_update[2] = true;
+		m_transform_generation = internal::transform_generation.fetch_add(1, std::memory_order_relaxed) + 1;
 
-		for (std::shared_ptr<Node>& child : m_children)
+		if (m_transform_store)
 		{
-			child->SignalTransformChange();
+			m_transform_store->MarkDirty(*this);
 		}
 	}
 
@@ -56,12 +66,14 @@ namespace wr
 
 	void Node::SignalTransformUpdate(unsigned int frame_idx)
 	{
-		m_requires_transform_update[frame_idx] = false;
+		m_transform_update_generations[frame_idx] = m_world_generation;
 	}
 
 	bool Node::RequiresTransformUpdate(unsigned int frame_idx)
 	{
-		return m_requires_transform_update[frame_idx];
+		m_world_generation = m_parent ? std::max(m_transform_generation, m_parent->m_world_generation) : m_transform_generation;
+
+		return m_world_generation != m_transform_update_generations[frame_idx];
 	}
 
 	void Node::SetRotation(DirectX::XMVECTOR roll_pitch_yaw)
@@ -15,13 +15,17 @@
  */
 #pragma once
 
+#include <array>
 #include <bitset>
 #include <functional>
 #include <memory>
+#include <cstdint>
 #include <DirectXMath.h>
 
 namespace wr
 {
+	class TransformStore;
+
 	struct Node : std::enable_shared_from_this<Node>
 	{
 		Node();
@@ -31,8 +35,10 @@ namespace wr
 		void SignalUpdate(unsigned int frame_idx);
 		bool RequiresUpdate(unsigned int frame_idx);
 
+		//Stamps the local transform with a new generation, children pick it up when their transform is updated
 		void SignalTransformChange();
 		void SignalTransformUpdate(unsigned int frame_idx);
+		//Compares the generation of this node and its parents against the last update; parents have to be checked first
 		bool RequiresTransformUpdate(unsigned int frame_idx);
 
 		//Takes roll, pitch and yaw and converts it to quaternion
@@ -52,6 +58,7 @@ namespace wr
 		virtual void SetTransform(DirectX::XMVECTOR position, DirectX::XMVECTOR rotation, DirectX::XMVECTOR scale);
 
 		//Update the transform; done automatically when SignalChange is called
+		//Nodes in a scene graph are updated in bulk by its `TransformStore` instead
 		void UpdateTransform();
 
 		std::shared_ptr<Node> m_parent;
@@ -78,7 +85,18 @@ namespace wr
 		bool m_use_quaternion = false;
 
 	private:
+		friend class TransformStore;
+
 		std::bitset<3> m_requires_update;
-		std::bitset<3> m_requires_transform_update;
+
+		//Generation of the last change to the local transform, and the newest generation of this node and its parents
+		std::uint64_t m_transform_generation = 0;
+		std::uint64_t m_world_generation = 0;
+		//The world generation every frame was last updated to
+		std::array<std::uint64_t, 3> m_transform_update_generations = {};
+
+		//The store that updates this node's transform and the node's entry in it
+		TransformStore* m_transform_store = nullptr;
+		std::uint32_t m_transform_index = 0;
 	};
 } // namespace wr
@@ -19,6 +19,7 @@
 
 #include "../renderer.hpp"
 #include "../util/log.hpp"
+#include "../util/parallel.hpp"
 
 #include "camera_node.hpp"
 #include "mesh_node.hpp"
@@ -66,6 +67,12 @@ namespace wr
 	void SceneGraph::RemoveChildren(std::shared_ptr<Node> const & parent)
 	{
 		parent->m_children.clear();
+		TransformStore::MarkHierarchyChanged(*parent);
+	}
+
+	TransformStore& SceneGraph::GetTransformStore()
+	{
+		return m_transform_store;
 	}
 
 	//! Returns the active camera.
@@ -159,7 +166,17 @@ namespace wr
 	*/
 	void SceneGraph::Render(CommandList* cmd_list, CameraNode* camera)
 	{
-		m_render_meshes_func_impl(m_render_system, m_batches, camera, cmd_list);
+		m_render_meshes_func_impl(m_render_system, m_batches, camera, cmd_list, 0, m_batches.size());
+	}
+
+	//! Render a range of the batches
+	/*!
+		Allows the batches to be recorded into multiple command lists in parallel. See `FrameGraph::RecordParallel`.
+		The order of the batches doesn't change as long as the scene graph isn't optimized in between.
+	*/
+	void SceneGraph::Render(CommandList* cmd_list, CameraNode* camera, std::size_t first_batch, std::size_t num_batches)
+	{
+		m_render_meshes_func_impl(m_render_system, m_batches, camera, cmd_list, first_batch, num_batches);
 	}
 
 	temp::MeshBatches& SceneGraph::GetBatches()
@@ -256,8 +273,35 @@ namespace wr
 			constexpr uint32_t max_size = d3d12::settings::num_instances_per_batch;
 			constexpr auto model_size = sizeof(temp::ObjectData) * max_size;
 
-			for (auto& node : m_mesh_nodes)
+			// Culling is independent per node, so it runs in parallel up front. Filling the batches stays serial.
+			constexpr std::uint8_t rasterizer_visible = 1;
+			constexpr std::uint8_t raytracer_visible = 2;
+
+			auto camera = GetActiveCamera();
+			const bool rt_culling = GetRTCullingEnabled();
+			const float rt_culling_distance = GetRTCullingDistance();
+
+			m_culling_results.resize(m_mesh_nodes.size());
+			util::ParallelFor(0, m_mesh_nodes.size(), 512, [&](std::size_t i)
+			{
+				auto& node = m_mesh_nodes[i];
+				std::uint8_t result = 0;
+
+				if (!d3d12::settings::enable_object_culling || camera->InView(node))
+				{
+					result |= rasterizer_visible;
+				}
+				if (!rt_culling || camera->InRange(node, rt_culling_distance))
+				{
+					result |= raytracer_visible;
+				}
+
+				m_culling_results[i] = result;
+			});
+
+			for (std::size_t node_i = 0; node_i < m_mesh_nodes.size(); ++node_i)
 			{
+				auto& node = m_mesh_nodes[node_i];
 
 				auto mesh_materials_pair = std::make_pair(node->m_model, node->m_materials);
 
@@ -302,7 +346,7 @@ namespace wr
 				batch.m_materials = node->GetMaterials();
 
 				//Cull for rasterizer
-				if (!d3d12::settings::enable_object_culling || GetActiveCamera()->InView(node))
+				if (m_culling_results[node_i] & rasterizer_visible)
 				{
 					unsigned int& offset = batch.num_instances;
 					batch.data.objects[offset] = { node->m_transform, node->m_prev_transform };
@@ -310,7 +354,7 @@ namespace wr
 				}
 
 				//Cull for raytracer
-				if (!GetRTCullingEnabled() || GetActiveCamera()->InRange(node, GetRTCullingDistance()))
+				if (m_culling_results[node_i] & raytracer_visible)
 				{
 					unsigned int& globalOffset = batch.num_global_instances;
 					obj->second[globalOffset] = { node->m_transform, node->m_prev_transform };
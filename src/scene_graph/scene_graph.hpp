@@ -23,6 +23,7 @@
 
 #include "node.hpp"
 #include "light_node.hpp"
+#include "transform_store.hpp"
 #include "../platform_independend_structs.hpp"
 #include "../util/user_literals.hpp"
 #include "../util/defines.hpp"
@@ -76,7 +77,7 @@ namespace wr
 		~SceneGraph();
 
 		// Impl Functions
-		static util::Delegate<void(RenderSystem*, temp::MeshBatches&, CameraNode* camera, CommandList*)> m_render_meshes_func_impl;
+		static util::Delegate<void(RenderSystem*, temp::MeshBatches&, CameraNode* camera, CommandList*, std::size_t first_batch, std::size_t num_batches)> m_render_meshes_func_impl;
 		static util::Delegate<void(RenderSystem*, std::vector<std::shared_ptr<MeshNode>>&)> m_init_meshes_func_impl;
 		static util::Delegate<void(RenderSystem*, std::vector<std::shared_ptr<CameraNode>>&)> m_init_cameras_func_impl;
 		static util::Delegate<void(RenderSystem*, std::vector<std::shared_ptr<LightNode>>&, std::vector<Light>&)> m_init_lights_func_impl;
@@ -97,6 +98,7 @@ namespace wr
 		std::vector<std::shared_ptr<Node>> GetChildren(std::shared_ptr<Node> const & parent = nullptr);
 		static void RemoveChildren(std::shared_ptr<Node> const & parent);
 		std::shared_ptr<CameraNode> GetActiveCamera();
+		TransformStore& GetTransformStore();
 
 		std::vector<std::shared_ptr<LightNode>>& GetLightNodes();
 		std::vector<std::shared_ptr<MeshNode>>& GetMeshNodes();
@@ -107,6 +109,7 @@ namespace wr
 		void Init();
 		void Update();
 		void Render(CommandList* cmd_list, CameraNode* camera);
+		void Render(CommandList* cmd_list, CameraNode* camera, std::size_t first_batch, std::size_t num_batches);
 
 		template<typename T>
 		void DestroyNode(std::shared_ptr<T> node);
@@ -149,6 +152,8 @@ namespace wr
 		std::vector<std::shared_ptr<MeshNode>> m_mesh_nodes;
 		std::vector<std::shared_ptr<LightNode>> m_light_nodes;
 		std::vector< std::shared_ptr<SkyboxNode>> m_skybox_nodes;
+		//! Per mesh node culling flags computed in parallel by `Optimize`. Kept around to avoid reallocating every frame.
+		std::vector<std::uint8_t> m_culling_results;
 
 		std::shared_ptr<SkyboxNode> m_default_skybox = nullptr;
 
@@ -156,6 +161,9 @@ namespace wr
 
 		uint32_t m_next_light_id = 0;
 		float m_rt_culling_distance = -1;
+
+		//Depth sorted transforms of all nodes. Declared last so it's destroyed first and detaches from the nodes
+		TransformStore m_transform_store;
 	};
 
 	//! Creates a child into the scene graph
@@ -170,6 +178,7 @@ namespace wr
 		auto new_node = std::make_shared<T>(args...);
 		p->m_children.push_back(new_node);
 		new_node->m_parent = p;
+		m_transform_store.MarkHierarchyChanged();
 
 		if constexpr (std::is_base_of<CameraNode, T>::value)
 		{
@@ -282,6 +291,7 @@ namespace wr
 		m_next_light_id = (uint32_t) m_light_nodes.size();
 
 		node->m_parent->m_children.erase(std::remove(node->m_parent->m_children.begin(), node->m_parent->m_children.end(), node), node->m_parent->m_children.end());
+		m_transform_store.MarkHierarchyChanged();
 
 		node.reset();
 	}
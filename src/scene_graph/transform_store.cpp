@@ -0,0 +1,215 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "transform_store.hpp"
+
+#include <algorithm>
+
+#include "node.hpp"
+#include "../util/parallel.hpp"
+
+namespace wr
+{
+
+	TransformStore::~TransformStore()
+	{
+		DetachNodes();
+	}
+
+	void TransformStore::MarkHierarchyChanged()
+	{
+		m_hierarchy_changed = true;
+	}
+
+	void TransformStore::MarkHierarchyChanged(Node const & parent)
+	{
+		if (parent.m_transform_store)
+		{
+			parent.m_transform_store->MarkHierarchyChanged();
+		}
+	}
+
+	void TransformStore::MarkDirty(Node const & node)
+	{
+		const auto index = node.m_transform_index;
+
+		if (index < m_nodes.size() && m_nodes[index].get() == &node)
+		{
+			m_local_generations[index] = node.m_transform_generation;
+			m_local_changed[index] = true;
+		}
+	}
+
+	void TransformStore::Update(std::shared_ptr<Node> const & root, unsigned int frame_idx)
+	{
+		if (m_hierarchy_changed || m_nodes.empty() || m_nodes[0] != root)
+		{
+			Rebuild(root);
+		}
+
+		const auto num_transforms = m_nodes.size();
+		auto& update_generations = m_update_generations[frame_idx];
+
+		// Copy the local transforms that changed since the last update into the store.
+		util::ParallelFor(0, num_transforms, grain_size, [&](std::size_t i)
+		{
+			if (!m_local_changed[i])
+			{
+				return;
+			}
+
+			auto& node = *m_nodes[i];
+			m_positions[i] = node.m_position;
+			m_rotations[i] = node.m_use_quaternion ? node.m_rotation : DirectX::XMQuaternionRotationRollPitchYawFromVector(node.m_rotation_radians);
+			m_scales[i] = node.m_scale;
+			m_local_changed[i] = false;
+		});
+
+		// Parents are in earlier levels, so every level only reads world matrices and generations that are already up to date.
+		// A node is outdated when it or any parent changed after the last update of this frame.
+		for (std::size_t level = 0; level + 1 < m_level_offsets.size(); ++level)
+		{
+			util::ParallelFor(m_level_offsets[level], m_level_offsets[level + 1], grain_size, [&](std::size_t i)
+			{
+				const auto parent = m_parents[i];
+				const auto generation = parent == no_parent ? m_local_generations[i] : std::max(m_local_generations[i], m_world_generations[parent]);
+				m_world_generations[i] = generation;
+
+				m_updated[i] = generation != update_generations[i];
+				if (!m_updated[i])
+				{
+					return;
+				}
+				update_generations[i] = generation;
+
+				const auto local = DirectX::XMMatrixScalingFromVector(m_scales[i])
+					* DirectX::XMMatrixRotationQuaternion(m_rotations[i])
+					* DirectX::XMMatrixTranslationFromVector(m_positions[i]);
+
+				m_local_transforms[i] = local;
+				m_prev_world_transforms[i] = m_world_transforms[i];
+				m_world_transforms[i] = parent == no_parent ? local : local * m_world_transforms[parent];
+			});
+		}
+
+		// Write the results back to the nodes.
+		util::ParallelFor(0, num_transforms, grain_size, [&](std::size_t i)
+		{
+			if (!m_updated[i])
+			{
+				return;
+			}
+
+			auto& node = *m_nodes[i];
+			node.m_rotation = m_rotations[i];
+			node.m_local_transform = m_local_transforms[i];
+			node.m_transform = m_world_transforms[i];
+			node.m_prev_transform = m_prev_world_transforms[i];
+			node.m_world_generation = m_world_generations[i];
+			node.SignalChange();
+			node.SignalTransformUpdate(frame_idx);
+		});
+	}
+
+	std::size_t TransformStore::GetNumTransforms() const
+	{
+		return m_nodes.size();
+	}
+
+	std::size_t TransformStore::GetNumLevels() const
+	{
+		return m_level_offsets.empty() ? 0 : m_level_offsets.size() - 1;
+	}
+
+	void TransformStore::Rebuild(std::shared_ptr<Node> const & root)
+	{
+		DetachNodes();
+
+		m_nodes.clear();
+		m_parents.clear();
+		m_level_offsets.clear();
+
+		// A breadth first traversal puts the nodes in depth order.
+		std::vector<std::uint32_t> depths;
+		m_nodes.push_back(root);
+		m_parents.push_back(no_parent);
+		depths.push_back(0);
+
+		for (std::uint32_t i = 0; i < m_nodes.size(); ++i)
+		{
+			if (depths[i] == m_level_offsets.size())
+			{
+				m_level_offsets.push_back(i);
+			}
+
+			// Copy the pointer, pushing the children can reallocate `m_nodes`.
+			auto node = m_nodes[i];
+			for (auto& child : node->m_children)
+			{
+				m_nodes.push_back(child);
+				m_parents.push_back(i);
+				depths.push_back(depths[i] + 1);
+			}
+		}
+
+		m_level_offsets.push_back(static_cast<std::uint32_t>(m_nodes.size()));
+
+		const auto num_transforms = m_nodes.size();
+		m_local_generations.resize(num_transforms);
+		m_world_generations.resize(num_transforms);
+		for (auto& update_generations : m_update_generations)
+		{
+			update_generations.resize(num_transforms);
+		}
+		m_local_changed.assign(num_transforms, true);
+		m_updated.resize(num_transforms);
+		m_positions.resize(num_transforms);
+		m_rotations.resize(num_transforms);
+		m_scales.resize(num_transforms);
+		m_local_transforms.resize(num_transforms);
+		m_world_transforms.resize(num_transforms);
+		m_prev_world_transforms.resize(num_transforms);
+
+		for (std::uint32_t i = 0; i < num_transforms; ++i)
+		{
+			auto& node = *m_nodes[i];
+			node.m_transform_store = this;
+			node.m_transform_index = i;
+
+			m_local_generations[i] = node.m_transform_generation;
+			for (std::size_t frame = 0; frame < m_update_generations.size(); ++frame)
+			{
+				m_update_generations[frame][i] = node.m_transform_update_generations[frame];
+			}
+			m_local_transforms[i] = node.m_local_transform;
+			m_world_transforms[i] = node.m_transform;
+			m_prev_world_transforms[i] = node.m_prev_transform;
+		}
+
+		m_hierarchy_changed = false;
+	}
+
+	void TransformStore::DetachNodes()
+	{
+		for (auto& node : m_nodes)
+		{
+			if (node->m_transform_store == this)
+			{
+				node->m_transform_store = nullptr;
+			}
+		}
+	}
+
+} /* wr */
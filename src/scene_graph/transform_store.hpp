@@ -0,0 +1,96 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <DirectXMath.h>
+
+namespace wr
+{
+	struct Node;
+
+	//! Transform Store
+	/*!
+		Keeps the transforms of a scene graph in contiguous arrays sorted by depth, so every parent comes before its children.
+		`Update` recomputes the world matrices one depth level at a time in linear passes instead of walking the node tree.
+
+		Nodes keep their public transform members. `Node::SignalTransformChange` copies the new generation of the node into the store,
+		`Update` copies the local position, rotation and scale of changed nodes into the store and writes the new matrices back to the nodes.
+		Changes reach the children through the generations while the levels are updated, so marking a node dirty doesn't touch its subtree.
+		The store is rebuilt on the next update after `MarkHierarchyChanged`, which the scene graph calls when nodes are added or removed.
+	*/
+	class TransformStore
+	{
+	public:
+		static constexpr std::uint32_t no_parent = std::numeric_limits<std::uint32_t>::max();
+		static constexpr std::size_t grain_size = 1024;
+
+		TransformStore() = default;
+		~TransformStore();
+
+		TransformStore(TransformStore const &) = delete;
+		TransformStore& operator=(TransformStore const &) = delete;
+
+		//! Rebuild the depth sorted arrays on the next update. Call this after editing `Node::m_children` directly.
+		void MarkHierarchyChanged();
+		//! Copy the transform generation of a node into its entry. Ignored when the node isn't in the store.
+		void MarkDirty(Node const & node);
+		//! Mark the hierarchy of the store `parent` belongs to as changed. For code that only has the node.
+		static void MarkHierarchyChanged(Node const & parent);
+
+		//! Update the world matrices of all dirty nodes under `root`.
+		void Update(std::shared_ptr<Node> const & root, unsigned int frame_idx);
+
+		//! Number of nodes in the store, including the root.
+		[[nodiscard]] std::size_t GetNumTransforms() const;
+		//! Number of depth levels. The root is level 0.
+		[[nodiscard]] std::size_t GetNumLevels() const;
+
+	private:
+		void Rebuild(std::shared_ptr<Node> const & root);
+		//! Clears the store pointer of every node so nodes that outlive the store don't touch it.
+		void DetachNodes();
+
+		std::vector<std::shared_ptr<Node>> m_nodes;
+		std::vector<std::uint32_t> m_parents;
+		//! First entry of every depth level followed by the number of entries.
+		std::vector<std::uint32_t> m_level_offsets;
+		//! Generation of the local transform, and the newest generation of the entry and its parents.
+		std::vector<std::uint64_t> m_local_generations;
+		std::vector<std::uint64_t> m_world_generations;
+		//! The world generation every entry was last updated to, one array per frame.
+		std::array<std::vector<std::uint64_t>, 3> m_update_generations;
+		//! Set when the local position, rotation or scale has to be copied from the node.
+		std::vector<std::uint8_t> m_local_changed;
+		//! Set for the entries updated by the current `Update`.
+		std::vector<std::uint8_t> m_updated;
+
+		std::vector<DirectX::XMVECTOR> m_positions;
+		//! Rotations are always stored as quaternions.
+		std::vector<DirectX::XMVECTOR> m_rotations;
+		std::vector<DirectX::XMVECTOR> m_scales;
+		std::vector<DirectX::XMMATRIX> m_local_transforms;
+		std::vector<DirectX::XMMATRIX> m_world_transforms;
+		std::vector<DirectX::XMMATRIX> m_prev_world_transforms;
+
+		bool m_hierarchy_changed = true;
+	};
+
+} /* wr */
@@ -20,6 +20,9 @@ namespace wr::settings
 
 	static const constexpr bool use_multithreading = true;
 	static const constexpr unsigned int num_frame_graph_threads = 4;
+	static const constexpr bool save_thread_pool_stats = false; // Write the thread pool telemetry of every frame graph to `frame_graph_<uid>_thread_pool_stats.json` when it's destroyed.
+	static const constexpr bool use_async_compute = false; // Submit compute tasks to the compute queue. Compute tasks have to declare their dependencies.
+	static const constexpr std::uint32_t max_coalesced_tasks = 1; // Maximum number of consecutive frame graph tasks recorded into one command list. 1 gives every task its own command list.
 
 	static const constexpr std::uint8_t default_textures_count = 5;
 	static const constexpr std::uint32_t default_textures_size_in_bytes = 4ul * 1024ul * 1024ul;
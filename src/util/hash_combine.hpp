@@ -0,0 +1,35 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace util
+{
+
+	/*! Combine the hash of a value into a seed. */
+	/*!
+		Used to build fingerprints out of multiple values, for example `RenderTaskDesc::m_fingerprint_func`.
+		The type has to be hashable with `std::hash`.
+	*/
+	template<typename T>
+	inline std::uint64_t HashCombine(std::uint64_t seed, T const & value)
+	{
+		return seed ^ (static_cast<std::uint64_t>(std::hash<T>()(value)) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+	}
+
+} /* util */
@@ -0,0 +1,258 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+namespace util
+{
+
+	//! A half open range of indices [m_begin, m_end).
+	struct IndexRange
+	{
+		std::size_t m_begin;
+		std::size_t m_end;
+
+		[[nodiscard]] std::size_t size() const noexcept
+		{
+			return m_end - m_begin;
+		}
+	};
+
+	/*! Number of chunks `PartitionRange` splits a range of `count` indices into. */
+	[[nodiscard]] inline std::size_t GetNumChunks(std::size_t count, std::size_t grain_size) noexcept
+	{
+		grain_size = std::max<std::size_t>(grain_size, 1);
+		return (count + grain_size - 1) / grain_size;
+	}
+
+	/*! Returns chunk `chunk` of [begin, end) split into chunks of `grain_size` indices. */
+	[[nodiscard]] inline IndexRange GetChunk(std::size_t begin, std::size_t end, std::size_t grain_size, std::size_t chunk) noexcept
+	{
+		grain_size = std::max<std::size_t>(grain_size, 1);
+		const auto chunk_begin = begin + chunk * grain_size;
+		return { chunk_begin, std::min(end, chunk_begin + grain_size) };
+	}
+
+	//! Splits [begin, end) into chunks of `grain_size` indices. The last chunk can be smaller.
+	/*!
+		The partitioning only depends on the range and the grain size, never on the number of threads.
+		This is what makes `ParallelReduce` and `ParallelSort` deterministic.
+	*/
+	[[nodiscard]] inline std::vector<IndexRange> PartitionRange(std::size_t begin, std::size_t end, std::size_t grain_size)
+	{
+		std::vector<IndexRange> chunks(GetNumChunks(end - begin, grain_size));
+		for (std::size_t i = 0; i < chunks.size(); ++i)
+		{
+			chunks[i] = GetChunk(begin, end, grain_size, i);
+		}
+		return chunks;
+	}
+
+	//! The pool used by the parallel algorithms when no pool is passed. Uses all hardware threads but the calling one.
+	inline ThreadPool& GetParallelThreadPool()
+	{
+		static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+		return pool;
+	}
+
+	namespace internal
+	{
+
+		//! Calls `func(chunk)` for every chunk in [0, num_chunks) and returns when all of them finished.
+		/*!
+			The calling thread takes part in the work and the pool only gets helper tasks that claim chunks from a shared counter.
+			Helpers that start late find no chunks left, so calling this from inside a pool task can't deadlock.
+		*/
+		template<typename F>
+		inline void RunChunks(ThreadPool& pool, std::size_t num_chunks, F const & func)
+		{
+			const auto num_helpers = std::min(pool.GetNumThreads(), num_chunks > 0 ? num_chunks - 1 : 0);
+			if (num_helpers == 0)
+			{
+				for (std::size_t i = 0; i < num_chunks; ++i)
+				{
+					func(i);
+				}
+				return;
+			}
+
+			// Shared with the helpers since they can outlive this call.
+			struct State
+			{
+				std::atomic<std::size_t> m_next = 0;
+				std::atomic<std::size_t> m_done = 0;
+			};
+			auto state = std::make_shared<State>();
+
+			auto work = [state, &func, num_chunks]()
+			{
+				std::size_t num_done = 0;
+				for (auto chunk = state->m_next.fetch_add(1, std::memory_order_relaxed); chunk < num_chunks; chunk = state->m_next.fetch_add(1, std::memory_order_relaxed))
+				{
+					func(chunk);
+					++num_done;
+				}
+
+				if (num_done > 0 && state->m_done.fetch_add(num_done, std::memory_order_acq_rel) + num_done == num_chunks)
+				{
+					state->m_done.notify_all();
+				}
+			};
+
+			for (std::size_t i = 0; i < num_helpers; ++i)
+			{
+				pool.Enqueue(work);
+			}
+
+			work();
+
+			for (auto done = state->m_done.load(std::memory_order_acquire); done < num_chunks; done = state->m_done.load(std::memory_order_acquire))
+			{
+				state->m_done.wait(done, std::memory_order_acquire);
+			}
+		}
+
+	} /* internal */
+
+	//! Calls `func(IndexRange)` for every chunk of [begin, end) in parallel.
+	template<typename F>
+	inline void ParallelForRange(ThreadPool& pool, std::size_t begin, std::size_t end, std::size_t grain_size, F const & func)
+	{
+		if (end <= begin)
+		{
+			return;
+		}
+
+		internal::RunChunks(pool, GetNumChunks(end - begin, grain_size), [&](std::size_t chunk)
+		{
+			func(GetChunk(begin, end, grain_size, chunk));
+		});
+	}
+
+	//! Calls `func(i)` for every index in [begin, end) in parallel. Every task handles `grain_size` indices.
+	template<typename F>
+	inline void ParallelFor(ThreadPool& pool, std::size_t begin, std::size_t end, std::size_t grain_size, F const & func)
+	{
+		ParallelForRange(pool, begin, end, grain_size, [&func](IndexRange range)
+		{
+			for (auto i = range.m_begin; i < range.m_end; ++i)
+			{
+				func(i);
+			}
+		});
+	}
+
+	//! Reduces [begin, end) in parallel.
+	/*!
+		`map(IndexRange, T identity)` reduces a single chunk and `reduce(T, T)` combines two partial results.
+		The partial results are combined in chunk order on the calling thread, so the result doesn't depend on the
+		number of threads or the scheduling. Floating point sums are reproducible as long as the grain size stays the same.
+	*/
+	template<typename T, typename Map, typename Reduce>
+	[[nodiscard]] inline T ParallelReduce(ThreadPool& pool, std::size_t begin, std::size_t end, std::size_t grain_size, T const & identity, Map const & map, Reduce const & reduce)
+	{
+		if (end <= begin)
+		{
+			return identity;
+		}
+
+		std::vector<T> partials(GetNumChunks(end - begin, grain_size), identity);
+		internal::RunChunks(pool, partials.size(), [&](std::size_t chunk)
+		{
+			partials[chunk] = map(GetChunk(begin, end, grain_size, chunk), identity);
+		});
+
+		T result = identity;
+		for (auto& partial : partials)
+		{
+			result = reduce(result, partial);
+		}
+		return result;
+	}
+
+	//! Sorts [first, last) in parallel.
+	/*!
+		Sorts chunks of `grain_size` elements and merges them pairwise in parallel rounds.
+		Like `std::sort` this isn't stable, but the result only depends on the input and the grain size.
+	*/
+	template<typename RandomIt, typename Compare = std::less<>>
+	inline void ParallelSort(ThreadPool& pool, RandomIt first, RandomIt last, std::size_t grain_size, Compare const & comp = Compare())
+	{
+		const auto count = static_cast<std::size_t>(std::distance(first, last));
+		grain_size = std::max<std::size_t>(grain_size, 1);
+
+		if (count <= grain_size)
+		{
+			std::sort(first, last, comp);
+			return;
+		}
+
+		ParallelForRange(pool, 0, count, grain_size, [&](IndexRange range)
+		{
+			std::sort(first + range.m_begin, first + range.m_end, comp);
+		});
+
+		for (auto width = grain_size; width < count; width *= 2)
+		{
+			ParallelForRange(pool, 0, GetNumChunks(count, width * 2), 1, [&](IndexRange range)
+			{
+				const auto begin = range.m_begin * width * 2;
+				const auto middle = std::min(count, begin + width);
+				const auto end = std::min(count, begin + width * 2);
+				std::inplace_merge(first + begin, first + middle, first + end, comp);
+			});
+		}
+	}
+
+	//! `ParallelForRange` on the default pool.
+	template<typename F>
+	inline void ParallelForRange(std::size_t begin, std::size_t end, std::size_t grain_size, F const & func)
+	{
+		ParallelForRange(GetParallelThreadPool(), begin, end, grain_size, func);
+	}
+
+	//! `ParallelFor` on the default pool.
+	template<typename F>
+	inline void ParallelFor(std::size_t begin, std::size_t end, std::size_t grain_size, F const & func)
+	{
+		ParallelFor(GetParallelThreadPool(), begin, end, grain_size, func);
+	}
+
+	//! `ParallelReduce` on the default pool.
+	template<typename T, typename Map, typename Reduce>
+	[[nodiscard]] inline T ParallelReduce(std::size_t begin, std::size_t end, std::size_t grain_size, T const & identity, Map const & map, Reduce const & reduce)
+	{
+		return ParallelReduce(GetParallelThreadPool(), begin, end, grain_size, identity, map, reduce);
+	}
+
+	//! `ParallelSort` on the default pool.
+	template<typename RandomIt, typename Compare = std::less<>>
+	inline void ParallelSort(RandomIt first, RandomIt last, std::size_t grain_size, Compare const & comp = Compare())
+	{
+		ParallelSort(GetParallelThreadPool(), first, last, grain_size, comp);
+	}
+
+} /* util */
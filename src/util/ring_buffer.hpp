@@ -0,0 +1,114 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace util
+{
+
+	//! Lock-free ring buffer
+	/*!
+		Any number of threads can push into the buffer without locking.
+		When the buffer is full the oldest values are overwritten.
+		Every slot has a sequence number that works like a seqlock, so a reader can take a snapshot
+		while other threads keep pushing and simply skips slots that are being written.
+		\tparam T Has to be trivially copyable.
+		\tparam N The number of slots.
+	*/
+	template<typename T, std::size_t N>
+	class RingBuffer
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "RingBuffer values have to be trivially copyable.");
+		static_assert(N > 0, "RingBuffer needs at least one slot.");
+
+	public:
+		RingBuffer() = default;
+
+		RingBuffer(RingBuffer const &) = delete;
+		RingBuffer& operator=(RingBuffer const &) = delete;
+
+		/*! Add a value, overwriting the oldest value when the buffer is full. */
+		void Push(T const & value)
+		{
+			const auto idx = m_head.fetch_add(1, std::memory_order_relaxed);
+			auto& slot = m_slots[idx % N];
+
+			// An odd sequence number marks the slot as being written.
+			slot.m_sequence.store(idx * 2 + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			slot.m_value = value;
+			slot.m_sequence.store(idx * 2 + 2, std::memory_order_release);
+		}
+
+		/*! Copy all values that are currently in the buffer, oldest first. */
+		std::vector<T> Snapshot() const
+		{
+			std::vector<T> retval;
+
+			const auto head = m_head.load(std::memory_order_acquire);
+			const auto begin = head > N ? head - N : 0;
+			retval.reserve(static_cast<std::size_t>(head - begin));
+
+			for (auto idx = begin; idx < head; ++idx)
+			{
+				auto const & slot = m_slots[idx % N];
+
+				if (slot.m_sequence.load(std::memory_order_acquire) != idx * 2 + 2)
+				{
+					continue;
+				}
+
+				T value = slot.m_value;
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				// Skip the value if a writer started overwriting it while we copied it.
+				if (slot.m_sequence.load(std::memory_order_relaxed) == idx * 2 + 2)
+				{
+					retval.push_back(value);
+				}
+			}
+
+			return retval;
+		}
+
+		/*! The number of values pushed since the buffer was created. */
+		std::uint64_t GetNumPushed() const
+		{
+			return m_head.load(std::memory_order_relaxed);
+		}
+
+		static constexpr std::size_t GetCapacity()
+		{
+			return N;
+		}
+
+	private:
+		struct Slot
+		{
+			std::atomic<std::uint64_t> m_sequence = 0;
+			T m_value = {};
+		};
+
+		std::atomic<std::uint64_t> m_head = 0;
+		std::array<Slot, N> m_slots;
+	};
+
+} /* util */
@@ -14,8 +14,8 @@
  * limitations under the License.
  */
 /*
-This thread pool is a modified version of https://github.com/progschj/ThreadPool.
-It is adjusted to fit our project structure better.
+This thread pool started as a modified version of https://github.com/progschj/ThreadPool.
+It has since been rewritten into a work-stealing pool, but keeps the interface and the license notice of the original.
 
 Original licesne:
 Copyright (c) 2012 Jakob Progsch, Václav Zeman
@@ -42,107 +42,1171 @@ freely, subject to the following restrictions:
 
 #pragma once
 
-#include <vector>
-#include <queue>
-#include <memory>
-#include <thread>
-#include <mutex>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
-#include <future>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
 #include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <sstream>
 #include <stdexcept>
-
-#include "delegate.hpp"
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace util
 {
 
+	class ThreadPool;
+
+	//! Priority lane of a task enqueued on a `ThreadPool`.
+	enum class TaskPriority : std::uint8_t
+	{
+		FRAME_CRITICAL, //!< Work the current frame waits on. Always taken before queued background tasks.
+		BACKGROUND, //!< Long running work such as asset import. Should call `ThreadPool::YieldToCriticalTasks` regularly.
+		COUNT
+	};
+
+	//! Occupancy of a priority lane of a `ThreadPool`.
+	struct TaskLaneStats
+	{
+		std::uint32_t m_num_queued = 0;
+		/*! The highest number of queued tasks since the pool was created. */
+		std::uint32_t m_max_queued = 0;
+		std::uint32_t m_num_running = 0;
+		std::uint64_t m_num_completed = 0;
+		/*! Time between enqueueing a task and a worker starting it. Zero when `TP_DISABLE_TELEMETRY` is defined. */
+		double m_average_latency_ms = 0.0;
+		double m_max_latency_ms = 0.0;
+	};
+
+	//! Telemetry of a single `ThreadPool` worker.
+	struct ThreadPoolWorkerStats
+	{
+		std::uint64_t m_num_tasks = 0;
+		/*! Tasks taken from the deque of another worker. */
+		std::uint64_t m_num_steals = 0;
+		/*! Time spent running tasks. Zero when `TP_DISABLE_TELEMETRY` is defined. */
+		double m_busy_ms = 0.0;
+		/*! Time spent looking for work or sleeping. */
+		double m_idle_ms = 0.0;
+	};
+
+	//! Telemetry of a `ThreadPool`. All counters are totals since the pool was created.
+	struct ThreadPoolStats
+	{
+		double m_uptime_ms = 0.0;
+		std::vector<ThreadPoolWorkerStats> m_workers;
+		/*! Indexed by `TaskPriority`. */
+		std::array<TaskLaneStats, static_cast<std::size_t>(TaskPriority::COUNT)> m_lanes;
+	};
+
+	namespace internal
+	{
+		struct TaskSlotBlock;
+
+		//! Storage of a task enqueued on a `ThreadPool`.
+		/*!
+			Slots are allocated up front by the pool and recycled, so enqueueing a task doesn't allocate.
+			The callable is stored inline. After it ran its return value is stored in the same memory.
+			A slot is shared by the pool and the `TaskFuture` of the task and is recycled when both released it.
+		*/
+		struct alignas(64) TaskSlot
+		{
+			static constexpr std::size_t storage_size = 128;
+
+			alignas(std::max_align_t) unsigned char m_storage[storage_size];
+			/*! Runs the callable, destroys it and stores the return value. */
+			void (*m_run)(TaskSlot&) = nullptr;
+			/*! Destroys the stored return value. `nullptr` when there is nothing to destroy. */
+			void (*m_destroy_result)(TaskSlot&) = nullptr;
+			std::atomic<std::uint32_t> m_references = 0;
+			std::atomic<bool> m_done = false;
+			/*! The number of threads in `TaskFuture::wait_for`. The worker only takes the timed wait lock when this isn't zero. */
+			std::atomic<std::uint32_t> m_num_timed_waiters = 0;
+			/*! The exception the task threw. Rethrown by `TaskFuture::get`. */
+			std::exception_ptr m_exception;
+			/*! The next slot in the free list of the block. */
+			std::atomic<std::uint32_t> m_next = 0;
+			/*! The block the slot belongs to. `nullptr` for slots allocated because the block ran out of slots. Those are deleted instead of recycled. */
+			TaskSlotBlock* m_block = nullptr;
+			TaskPriority m_priority = TaskPriority::FRAME_CRITICAL;
+			/*! `steady_clock` ticks at the time the task was enqueued. Used for the enqueue-to-start latency. */
+			std::chrono::steady_clock::rep m_enqueue_time = 0;
+		};
+
+		//! The recycled task slots of a `ThreadPool`.
+		/*!
+			The free list is a lock-free stack. Its head holds a tag in the upper 32 bits to prevent ABA problems.
+			The block is reference counted by the pool and the slots in use, so a `TaskFuture` can outlive its pool.
+		*/
+		struct TaskSlotBlock
+		{
+			static constexpr std::uint32_t no_slot = 0xFFFFFFFFu;
+
+			explicit TaskSlotBlock(std::uint32_t num_slots) :
+				m_slots(new TaskSlot[num_slots])
+			{
+				for (std::uint32_t i = 0; i < num_slots; ++i)
+				{
+					m_slots[i].m_block = this;
+					Push(i);
+				}
+			}
+
+			/*! Take a slot. Returns `nullptr` when all slots are in use. */
+			TaskSlot* Allocate()
+			{
+				auto head = m_free_slots.load(std::memory_order_acquire);
+
+				for (;;)
+				{
+					const auto index = static_cast<std::uint32_t>(head & no_slot);
+					if (index == no_slot)
+					{
+						return nullptr;
+					}
+
+					const auto next = m_slots[index].m_next.load(std::memory_order_relaxed);
+					const auto new_head = (((head >> 32) + 1) << 32) | next;
+					if (m_free_slots.compare_exchange_weak(head, new_head, std::memory_order_acq_rel, std::memory_order_acquire))
+					{
+						m_references.fetch_add(1, std::memory_order_relaxed);
+						return &m_slots[index];
+					}
+				}
+			}
+
+			/*! Return a slot taken with `Allocate`. */
+			void Free(TaskSlot* slot)
+			{
+				Push(static_cast<std::uint32_t>(slot - m_slots.get()));
+				Release();
+			}
+
+			void Release()
+			{
+				if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					delete this;
+				}
+			}
+
+		private:
+			void Push(std::uint32_t index)
+			{
+				auto head = m_free_slots.load(std::memory_order_relaxed);
+
+				for (;;)
+				{
+					m_slots[index].m_next.store(static_cast<std::uint32_t>(head & no_slot), std::memory_order_relaxed);
+					const auto new_head = (((head >> 32) + 1) << 32) | index;
+					if (m_free_slots.compare_exchange_weak(head, new_head, std::memory_order_release, std::memory_order_relaxed))
+					{
+						return;
+					}
+				}
+			}
+
+			std::unique_ptr<TaskSlot[]> m_slots;
+			alignas(64) std::atomic<std::uint64_t> m_free_slots = no_slot;
+			std::atomic<std::uint32_t> m_references = 1;
+		};
+
+		/*! Values that don't fit in a slot are stored on the heap. */
+		template<typename T>
+		using SlotStorage = std::conditional_t<(sizeof(T) <= TaskSlot::storage_size && alignof(T) <= alignof(std::max_align_t)), T, std::unique_ptr<T>>;
+
+		template<typename T>
+		inline T& GetStored(SlotStorage<T>& stored)
+		{
+			if constexpr (std::is_same_v<SlotStorage<T>, T>)
+			{
+				return stored;
+			}
+			else
+			{
+				return *stored;
+			}
+		}
+
+		template<typename T>
+		inline SlotStorage<T>* GetSlotStorage(TaskSlot& slot)
+		{
+			return std::launder(reinterpret_cast<SlotStorage<T>*>(slot.m_storage));
+		}
+
+		template<typename T>
+		inline void Store(TaskSlot& slot, T&& value)
+		{
+			using value_t = std::decay_t<T>;
+
+			if constexpr (std::is_same_v<SlotStorage<value_t>, value_t>)
+			{
+				new (slot.m_storage) value_t(std::forward<T>(value));
+			}
+			else
+			{
+				new (slot.m_storage) SlotStorage<value_t>(std::make_unique<value_t>(std::forward<T>(value)));
+			}
+		}
+
+		/*! Lock and condition variable shared by all `TaskFuture::wait_for` calls. `std::atomic::wait` can't time out. */
+		struct TimedWait
+		{
+			std::mutex m_mutex;
+			std::condition_variable m_condition;
+		};
+
+		inline TimedWait& GetTimedWait()
+		{
+			static TimedWait timed_wait;
+			return timed_wait;
+		}
+
+		/*! Mark a task as finished and wake up the threads waiting for it. */
+		inline void CompleteTaskSlot(TaskSlot& slot)
+		{
+			slot.m_done.store(true, std::memory_order_seq_cst);
+			slot.m_done.notify_all();
+
+			// A timed waiter registers before it checks `m_done` under the lock, so either it sees the task finished or it gets notified.
+			if (slot.m_num_timed_waiters.load(std::memory_order_seq_cst) > 0)
+			{
+				auto& timed_wait = GetTimedWait();
+				{
+					std::lock_guard<std::mutex> lock(timed_wait.m_mutex);
+				}
+				timed_wait.m_condition.notify_all();
+			}
+		}
+
+		/*! Drop a reference to a slot. The last reference destroys the return value and recycles the slot. */
+		inline void ReleaseTaskSlot(TaskSlot* slot)
+		{
+			if (slot->m_references.fetch_sub(1, std::memory_order_acq_rel) != 1)
+			{
+				return;
+			}
+
+			if (slot->m_destroy_result)
+			{
+				slot->m_destroy_result(*slot);
+				slot->m_destroy_result = nullptr;
+			}
+			slot->m_exception = nullptr;
+
+			if (slot->m_block)
+			{
+				slot->m_block->Free(slot);
+			}
+			else
+			{
+				delete slot;
+			}
+		}
+
+		//! Work-stealing deque.
+		/*!
+			Chase-Lev deque. Only the owning worker pushes and pops at the bottom, other workers steal from the top.
+			None of the operations lock. Pushing fails when the deque is full.
+		*/
+		template<std::size_t N>
+		class WorkStealingDeque
+		{
+			static_assert((N & (N - 1)) == 0, "The capacity of the deque has to be a power of two.");
+
+		public:
+			/*! Add a task at the bottom. Only call this from the owning worker. */
+			bool Push(TaskSlot* slot)
+			{
+				const auto bottom = m_bottom.load(std::memory_order_relaxed);
+				const auto top = m_top.load(std::memory_order_acquire);
+
+				if (bottom - top >= static_cast<std::int64_t>(N))
+				{
+					return false;
+				}
+
+				m_tasks[bottom & (N - 1)].store(slot, std::memory_order_relaxed);
+				m_bottom.store(bottom + 1, std::memory_order_release);
+
+				return true;
+			}
+
+			/*! Take the task that was pushed last. Only call this from the owning worker. */
+			TaskSlot* Pop()
+			{
+				// Reserve the bottom task before looking at the top, so a thief can't take it at the same time unless it's the last one.
+				const auto bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+				m_bottom.store(bottom, std::memory_order_seq_cst);
+				auto top = m_top.load(std::memory_order_seq_cst);
+
+				if (top > bottom)
+				{
+					m_bottom.store(bottom + 1, std::memory_order_relaxed);
+					return nullptr;
+				}
+
+				auto slot = m_tasks[bottom & (N - 1)].load(std::memory_order_relaxed);
+
+				// The last task can be stolen at the same time.
+				if (top == bottom)
+				{
+					if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					{
+						slot = nullptr;
+					}
+					m_bottom.store(bottom + 1, std::memory_order_relaxed);
+				}
+
+				return slot;
+			}
+
+			/*! Take the task that was pushed first. Can be called from any thread. */
+			TaskSlot* Steal()
+			{
+				auto top = m_top.load(std::memory_order_seq_cst);
+				const auto bottom = m_bottom.load(std::memory_order_seq_cst);
+
+				if (top >= bottom)
+				{
+					return nullptr;
+				}
+
+				auto slot = m_tasks[top & (N - 1)].load(std::memory_order_relaxed);
+				if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				{
+					return nullptr;
+				}
+
+				return slot;
+			}
+
+		private:
+			alignas(64) std::atomic<std::int64_t> m_top = 0;
+			alignas(64) std::atomic<std::int64_t> m_bottom = 0;
+			std::array<std::atomic<TaskSlot*>, N> m_tasks = {};
+		};
+
+		//! Bounded lock-free multi producer multi consumer queue.
+		/*!
+			Every cell has a sequence number that tells producers and consumers whether it is free or filled.
+			Used for tasks enqueued by threads that are not workers of the pool.
+		*/
+		template<std::size_t N>
+		class InjectionQueue
+		{
+			static_assert((N & (N - 1)) == 0, "The capacity of the queue has to be a power of two.");
+
+		public:
+			InjectionQueue()
+			{
+				for (std::size_t i = 0; i < N; ++i)
+				{
+					m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+				}
+			}
+
+			bool Push(TaskSlot* slot)
+			{
+				auto position = m_enqueue_position.load(std::memory_order_relaxed);
+
+				for (;;)
+				{
+					auto& cell = m_cells[position & (N - 1)];
+					const auto difference = static_cast<std::int64_t>(cell.m_sequence.load(std::memory_order_acquire)) - static_cast<std::int64_t>(position);
+
+					if (difference == 0)
+					{
+						if (m_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						{
+							cell.m_slot = slot;
+							cell.m_sequence.store(position + 1, std::memory_order_release);
+							return true;
+						}
+					}
+					else if (difference < 0)
+					{
+						return false;
+					}
+					else
+					{
+						position = m_enqueue_position.load(std::memory_order_relaxed);
+					}
+				}
+			}
+
+			TaskSlot* Pop()
+			{
+				auto position = m_dequeue_position.load(std::memory_order_relaxed);
+
+				for (;;)
+				{
+					auto& cell = m_cells[position & (N - 1)];
+					const auto difference = static_cast<std::int64_t>(cell.m_sequence.load(std::memory_order_acquire)) - static_cast<std::int64_t>(position + 1);
+
+					if (difference == 0)
+					{
+						if (m_dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						{
+							auto slot = cell.m_slot;
+							cell.m_sequence.store(position + N, std::memory_order_release);
+							return slot;
+						}
+					}
+					else if (difference < 0)
+					{
+						return nullptr;
+					}
+					else
+					{
+						position = m_dequeue_position.load(std::memory_order_relaxed);
+					}
+				}
+			}
+
+		private:
+			struct Cell
+			{
+				std::atomic<std::size_t> m_sequence;
+				TaskSlot* m_slot = nullptr;
+			};
+
+			alignas(64) std::atomic<std::size_t> m_enqueue_position = 0;
+			alignas(64) std::atomic<std::size_t> m_dequeue_position = 0;
+			std::array<Cell, N> m_cells;
+		};
+	} /* internal */
+
+	//! Completion token of a task enqueued on a `ThreadPool`.
+	/*!
+		Replaces `std::future` with a token that doesn't allocate a shared state.
+		Supports the subset of `std::future` the renderer uses: `valid`, `wait`, `wait_for` and `get`.
+		Unlike `std::future::get`, waiting doesn't consume the token, so `wait` can be called any number of times.
+		Like `std::future`, `get` rethrows the exception the task threw.
+		A token must only be used by one thread at a time.
+	*/
+	template<typename R>
+	class TaskFuture
+	{
+	public:
+		TaskFuture() = default;
+
+		explicit TaskFuture(internal::TaskSlot* slot) noexcept :
+			m_slot(slot)
+		{
+		}
+
+		TaskFuture(TaskFuture const &) = delete;
+		TaskFuture& operator=(TaskFuture const &) = delete;
+
+		TaskFuture(TaskFuture&& other) noexcept :
+			m_slot(std::exchange(other.m_slot, nullptr))
+		{
+		}
+
+		TaskFuture& operator=(TaskFuture&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Reset();
+				m_slot = std::exchange(other.m_slot, nullptr);
+			}
+
+			return *this;
+		}
+
+		~TaskFuture()
+		{
+			Reset();
+		}
+
+		/*! Whether the token refers to a task. */
+		[[nodiscard]] bool valid() const noexcept
+		{
+			return m_slot != nullptr;
+		}
+
+		/*! Block until the task finished. */
+		void wait() const
+		{
+			while (!m_slot->m_done.load(std::memory_order_acquire))
+			{
+				m_slot->m_done.wait(false, std::memory_order_acquire);
+			}
+		}
+
+		/*! Wait until the task finished or the timeout expired. A zero timeout polls the task. */
+		template<class Rep, class Period>
+		std::future_status wait_for(std::chrono::duration<Rep, Period> const & timeout) const
+		{
+			if (m_slot->m_done.load(std::memory_order_acquire))
+			{
+				return std::future_status::ready;
+			}
+			if (timeout <= timeout.zero())
+			{
+				return std::future_status::timeout;
+			}
+
+			auto& timed_wait = internal::GetTimedWait();
+			m_slot->m_num_timed_waiters.fetch_add(1, std::memory_order_seq_cst);
+
+			bool done;
+			{
+				std::unique_lock<std::mutex> lock(timed_wait.m_mutex);
+				done = timed_wait.m_condition.wait_for(lock, timeout, [this] { return m_slot->m_done.load(std::memory_order_seq_cst); });
+			}
+
+			m_slot->m_num_timed_waiters.fetch_sub(1, std::memory_order_relaxed);
+
+			return done ? std::future_status::ready : std::future_status::timeout;
+		}
+
+		/*! Wait for the task and take its return value. Releases the token. */
+		/*!
+			Rethrows the exception the task threw, the token is released in that case as well.
+		*/
+		R get()
+		{
+			wait();
+
+			if (m_slot->m_exception)
+			{
+				auto exception = m_slot->m_exception;
+				Reset();
+				std::rethrow_exception(exception);
+			}
+
+			if constexpr (std::is_void_v<R>)
+			{
+				Reset();
+			}
+			else
+			{
+				R retval = std::move(internal::GetStored<R>(*internal::GetSlotStorage<R>(*m_slot)));
+				Reset();
+				return retval;
+			}
+		}
+
+	private:
+		void Reset()
+		{
+			if (m_slot)
+			{
+				internal::ReleaseTaskSlot(std::exchange(m_slot, nullptr));
+			}
+		}
+
+		internal::TaskSlot* m_slot = nullptr;
+	};
+
+	//! Work-stealing thread pool
+	/*!
+		Every worker owns a lock-free deque. Tasks enqueued by a worker go to its own deque,
+		tasks enqueued by other threads go to a shared lock-free injection queue.
+		Idle workers take tasks from their own deque first, then from the injection queue and then steal from the other workers.
+		Every priority lane has its own deques and injection queue. Workers only look at the background lane when there is no frame-critical work,
+		and at most `GetMaxBackgroundThreads()` workers run background tasks at the same time so frame work always finds a free worker.
+		Running background tasks give way to frame work by calling `YieldToCriticalTasks`.
+		The pool counts executed and stolen tasks per worker and, unless `TP_DISABLE_TELEMETRY` is defined, times busy time and the enqueue-to-start latency. See `GetStats`.
+		Task storage is recycled, so enqueueing a task doesn't allocate unless the callable or its return value is larger than `internal::TaskSlot::storage_size`,
+		or more than `max_pooled_tasks` tasks are alive at the same time.
+
+		Contract:
+		- An exception thrown by a task is caught by the worker and rethrown by `TaskFuture::get`.
+		- Enqueueing on a pool that is being destroyed throws `std::runtime_error`. Tasks that were enqueued before still run.
+		- A pool without threads runs every task on the enqueueing thread before `Enqueue` returns.
+		- When the queues are full the enqueueing thread runs the task itself instead of waiting for room.
+	*/
 	class ThreadPool
 	{
 	public:
-		ThreadPool(size_t);
+		static constexpr std::size_t max_pooled_tasks = 1024;
+		static constexpr std::size_t deque_capacity = 1024;
+		static constexpr std::size_t injection_queue_capacity = 4096;
+		static constexpr std::size_t num_priorities = static_cast<std::size_t>(TaskPriority::COUNT);
+
+		explicit ThreadPool(std::size_t num_threads);
+		~ThreadPool();
+
+		ThreadPool(ThreadPool const &) = delete;
+		ThreadPool& operator=(ThreadPool const &) = delete;
+
+		/*! Run a function on a worker thread. */
+		/*!
+			\return A `TaskFuture` that can be used to wait for the function and obtain its return value.
+		*/
 		template<class F, class... Args>
 		decltype(auto) Enqueue(F&& f, Args&&... args);
-		~ThreadPool();
+
+		/*! Run a function on a worker thread in the given priority lane. `Enqueue` uses `TaskPriority::FRAME_CRITICAL`. */
+		template<class F, class... Args>
+		decltype(auto) EnqueueWithPriority(TaskPriority priority, F&& f, Args&&... args);
+
+		//! Runs queued frame-critical tasks on the calling worker before returning.
+		/*!
+			Long running background tasks call this between steps to cooperatively give way to frame work.
+			Does nothing when called from a thread that isn't a worker of this pool.
+			\return The number of tasks that ran.
+		*/
+		std::size_t YieldToCriticalTasks();
+
+		/*! Whether frame-critical tasks are waiting for a worker. Cheaper than `YieldToCriticalTasks` when polled often. */
+		[[nodiscard]] bool HasQueuedCriticalTasks() const noexcept
+		{
+			return m_lanes[static_cast<std::size_t>(TaskPriority::FRAME_CRITICAL)].m_num_queued.load(std::memory_order_relaxed) > 0;
+		}
+
+		/*! Limit the number of workers that run background tasks at the same time. */
+		void SetMaxBackgroundThreads(std::size_t num_threads) noexcept
+		{
+			m_max_background_threads.store(static_cast<std::uint32_t>(std::max<std::size_t>(num_threads, 1)), std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] std::size_t GetMaxBackgroundThreads() const noexcept
+		{
+			return m_max_background_threads.load(std::memory_order_relaxed);
+		}
+
+		/*! Snapshot of the occupancy of a priority lane. The counters are read separately, so they can be slightly out of sync. */
+		[[nodiscard]] TaskLaneStats GetLaneStats(TaskPriority priority) const noexcept;
+
+		/*! Snapshot of the telemetry of all workers and lanes. Cheap enough to poll every frame. */
+		[[nodiscard]] ThreadPoolStats GetStats() const;
+
+		/*! The number of worker threads. */
+		[[nodiscard]] std::size_t GetNumThreads() const noexcept
+		{
+			return m_workers.size();
+		}
 
 	private:
-		// need to keep track of threads so we can join them
+		using clock_t = std::chrono::steady_clock;
+
+		/*! Counters of a worker. Only written by the worker itself, so they are updated without read-modify-write operations. */
+		struct alignas(64) WorkerTelemetry
+		{
+			std::atomic<std::uint64_t> m_num_tasks = 0;
+			std::atomic<std::uint64_t> m_num_steals = 0;
+			std::atomic<std::uint64_t> m_busy_ns = 0;
+			std::array<std::atomic<std::uint64_t>, num_priorities> m_num_started = {};
+			std::array<std::atomic<std::uint64_t>, num_priorities> m_total_latency_ns = {};
+			std::array<std::atomic<std::uint64_t>, num_priorities> m_max_latency_ns = {};
+			/*! Tasks can run inside tasks through `YieldToCriticalTasks` or a full queue. Only the outermost one counts as busy time. */
+			std::uint32_t m_depth = 0;
+		};
+
+		struct Worker
+		{
+			std::array<internal::WorkStealingDeque<deque_capacity>, num_priorities> m_deques;
+			WorkerTelemetry m_telemetry;
+		};
+
+		struct alignas(64) Lane
+		{
+			/*! Incremented before a task is pushed, so a task in a queue of the lane is always counted. */
+			std::atomic<std::uint32_t> m_num_queued = 0;
+			std::atomic<std::uint32_t> m_max_queued = 0;
+			std::atomic<std::uint32_t> m_num_running = 0;
+			std::atomic<std::uint64_t> m_num_completed = 0;
+		};
+
+		static void Add(std::atomic<std::uint64_t>& counter, std::uint64_t value) noexcept
+		{
+			counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		}
+
+		void WorkerLoop(std::uint32_t index);
+		internal::TaskSlot* FindTask(std::uint32_t index);
+		internal::TaskSlot* PopTask(std::uint32_t index, TaskPriority priority);
+		void RunTask(std::optional<std::uint32_t> index, internal::TaskSlot* slot);
+		void Submit(internal::TaskSlot* slot);
+		internal::TaskSlot* AllocateSlot();
+
 		std::vector<std::thread> m_workers;
-		// the task queue
-		std::queue<Delegate<void()>> m_tasks;
+		std::vector<std::unique_ptr<Worker>> m_worker_data;
+		std::array<internal::InjectionQueue<injection_queue_capacity>, num_priorities> m_injection_queues;
+		std::array<Lane, num_priorities> m_lanes;
+		std::atomic<std::uint32_t> m_max_background_threads;
+		clock_t::time_point m_start;
+
+		/*! Recycled task storage. */
+		internal::TaskSlotBlock* m_slots;
+
+		/*! Incremented when a task is enqueued. Sleeping workers wait for it to change. */
+		alignas(64) std::atomic<std::uint32_t> m_epoch = 0;
+		std::atomic<std::uint32_t> m_num_sleeping = 0;
+		std::atomic<bool> m_stop = false;
 
-		// synchronization
-		std::mutex m_queue_mutex;
-		std::condition_variable m_condition;
-		bool m_stop;
+		/*! The pool and worker index of the calling thread. */
+		static inline thread_local std::pair<ThreadPool const *, std::uint32_t> m_current_worker = { nullptr, 0 };
 	};
 
-	// the constructor just launches some amount of workers
-	inline ThreadPool::ThreadPool(std::size_t threads)
-		: m_stop(false)
+	inline ThreadPool::ThreadPool(std::size_t num_threads) :
+		m_max_background_threads(static_cast<std::uint32_t>(num_threads > 1 ? num_threads - 1 : 1)),
+		m_start(clock_t::now()),
+		m_slots(new internal::TaskSlotBlock(max_pooled_tasks))
 	{
-		for (decltype(threads) i = 0; i < threads; ++i)
-			m_workers.emplace_back(
-				[this]
+		for (std::size_t i = 0; i < num_threads; ++i)
 		{
-			for (;;)
+			m_worker_data.push_back(std::make_unique<Worker>());
+		}
+
+		for (std::uint32_t i = 0; i < num_threads; ++i)
+		{
+			m_workers.emplace_back([this, i] { WorkerLoop(i); });
+		}
+	}
+
+	// add new work item to the pool
+	template<class F, class... Args>
+	decltype(auto) ThreadPool::Enqueue(F&& f, Args&&... args)
+	{
+		return EnqueueWithPriority(TaskPriority::FRAME_CRITICAL, std::forward<F>(f), std::forward<Args>(args)...);
+	}
+
+	template<class F, class... Args>
+	decltype(auto) ThreadPool::EnqueueWithPriority(TaskPriority priority, F&& f, Args&&... args)
+	{
+		using return_type = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+
+		auto callable = [f = std::forward<F>(f), arguments = std::make_tuple(std::forward<Args>(args)...)]() mutable -> return_type
+		{
+			return std::apply(f, std::move(arguments));
+		};
+		using callable_t = decltype(callable);
+
+		// Same as the original pool, the workers might already be gone.
+		if (m_stop.load(std::memory_order_acquire))
+		{
+			throw std::runtime_error("Enqueue on a stopped ThreadPool");
+		}
+
+		auto slot = AllocateSlot();
+		internal::Store(*slot, std::move(callable));
+
+		slot->m_run = [](internal::TaskSlot& slot)
+		{
+			auto stored_callable = internal::GetSlotStorage<callable_t>(slot);
+			bool destroyed_callable = false;
+
+			// The exception is handed to the token, a worker never sees it.
+			try
 			{
-				Delegate<void()> task;
+				if constexpr (std::is_void_v<return_type>)
+				{
+					internal::GetStored<callable_t>(*stored_callable)();
+					std::destroy_at(stored_callable);
+					destroyed_callable = true;
+				}
+				else
+				{
+					return_type result = internal::GetStored<callable_t>(*stored_callable)();
+					std::destroy_at(stored_callable);
+					destroyed_callable = true;
 
+					internal::Store(slot, std::move(result));
+					slot.m_destroy_result = [](internal::TaskSlot& slot)
+					{
+						std::destroy_at(internal::GetSlotStorage<return_type>(slot));
+					};
+				}
+			}
+			catch (...)
+			{
+				if (!destroyed_callable)
 				{
-					std::unique_lock<std::mutex> lock(m_queue_mutex);
+					std::destroy_at(stored_callable);
+				}
+				slot.m_exception = std::current_exception();
+			}
+		};
 
-					m_condition.wait(lock,
-						[this] { return m_stop || !m_tasks.empty(); });
-					if (m_stop && m_tasks.empty())
-						return;
-					task = std::move(m_tasks.front());
-					m_tasks.pop();
+		// Released by the worker that runs the task and by the returned token.
+		slot->m_references.store(2, std::memory_order_relaxed);
+		slot->m_done.store(false, std::memory_order_relaxed);
+		slot->m_priority = priority;
+#ifndef TP_DISABLE_TELEMETRY
+		slot->m_enqueue_time = clock_t::now().time_since_epoch().count();
+#endif
+
+		Submit(slot);
+
+		return TaskFuture<return_type>(slot);
+	}
+
+	inline void ThreadPool::Submit(internal::TaskSlot* slot)
+	{
+		const bool is_worker = m_current_worker.first == this;
+		const auto lane = static_cast<std::size_t>(slot->m_priority);
+
+		const auto num_queued = m_lanes[lane].m_num_queued.fetch_add(1, std::memory_order_relaxed) + 1;
+		for (auto max_queued = m_lanes[lane].m_max_queued.load(std::memory_order_relaxed); num_queued > max_queued;)
+		{
+			if (m_lanes[lane].m_max_queued.compare_exchange_weak(max_queued, num_queued, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+
+		const bool queued = !m_worker_data.empty()
+			&& ((is_worker && m_worker_data[m_current_worker.second]->m_deques[lane].Push(slot)) || m_injection_queues[lane].Push(slot));
+
+		// Without workers, or with full queues, the calling thread runs the task. Waiting for room could wait forever.
+		if (!queued)
+		{
+			m_lanes[lane].m_num_queued.fetch_sub(1, std::memory_order_relaxed);
+			m_lanes[lane].m_num_running.fetch_add(1, std::memory_order_relaxed);
+			RunTask(is_worker ? std::optional<std::uint32_t>(m_current_worker.second) : std::nullopt, slot);
+			return;
+		}
+
+		m_epoch.fetch_add(1, std::memory_order_seq_cst);
+		if (m_num_sleeping.load(std::memory_order_seq_cst) > 0)
+		{
+			m_epoch.notify_one();
+		}
+	}
+
+	inline void ThreadPool::WorkerLoop(std::uint32_t index)
+	{
+		m_current_worker = { this, index };
+
+		constexpr int num_spins = 64;
+
+		for (;;)
+		{
+			auto task = FindTask(index);
+
+			// Stay awake for a moment, new tasks tend to arrive in bursts.
+			for (int spin = 0; !task && spin < num_spins; ++spin)
+			{
+				std::this_thread::yield();
+				task = FindTask(index);
+			}
+
+			if (task)
+			{
+				RunTask(index, task);
+				continue;
+			}
+
+			// Announce that this worker is going to sleep before checking for work one last time, so a task enqueued in between wakes it up.
+			const auto epoch = m_epoch.load(std::memory_order_seq_cst);
+			m_num_sleeping.fetch_add(1, std::memory_order_seq_cst);
+
+			task = FindTask(index);
+			if (!task && m_stop.load(std::memory_order_seq_cst))
+			{
+				m_num_sleeping.fetch_sub(1, std::memory_order_seq_cst);
+				return;
+			}
+
+			if (!task)
+			{
+				m_epoch.wait(epoch, std::memory_order_seq_cst);
+			}
+
+			m_num_sleeping.fetch_sub(1, std::memory_order_seq_cst);
+
+			if (task)
+			{
+				RunTask(index, task);
+			}
+		}
+	}
+
+	inline internal::TaskSlot* ThreadPool::FindTask(std::uint32_t index)
+	{
+		if (auto task = PopTask(index, TaskPriority::FRAME_CRITICAL); task)
+		{
+			return task;
+		}
+
+		return PopTask(index, TaskPriority::BACKGROUND);
+	}
+
+	// Takes a task from the lane and counts it as running.
+	inline internal::TaskSlot* ThreadPool::PopTask(std::uint32_t index, TaskPriority priority)
+	{
+		const auto lane_index = static_cast<std::size_t>(priority);
+		auto& lane = m_lanes[lane_index];
+
+		if (lane.m_num_queued.load(std::memory_order_relaxed) == 0)
+		{
+			return nullptr;
+		}
+
+		// Reserve a running spot first, so no more than the maximum number of workers pick up background tasks.
+		if (priority == TaskPriority::BACKGROUND)
+		{
+			const auto max_running = m_max_background_threads.load(std::memory_order_relaxed);
+			auto num_running = lane.m_num_running.load(std::memory_order_relaxed);
+			do
+			{
+				if (num_running >= max_running)
+				{
+					return nullptr;
 				}
+			} while (!lane.m_num_running.compare_exchange_weak(num_running, num_running + 1, std::memory_order_relaxed));
+		}
+		else
+		{
+			lane.m_num_running.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		auto task = m_worker_data[index]->m_deques[lane_index].Pop();
 
-				task();
+		if (!task)
+		{
+			task = m_injection_queues[lane_index].Pop();
+		}
+
+		const auto num_workers = static_cast<std::uint32_t>(m_worker_data.size());
+		for (std::uint32_t i = 1; !task && i < num_workers; ++i)
+		{
+			task = m_worker_data[(index + i) % num_workers]->m_deques[lane_index].Steal();
+
+			if (task)
+			{
+				Add(m_worker_data[index]->m_telemetry.m_num_steals, 1);
 			}
 		}
-		);
+
+		if (!task)
+		{
+			lane.m_num_running.fetch_sub(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		lane.m_num_queued.fetch_sub(1, std::memory_order_relaxed);
+		return task;
 	}
 
-	// add new work item to the pool
-	template<class F, class... Args>
-	decltype(auto) ThreadPool::Enqueue(F&& f, Args&&... args)
+	inline std::size_t ThreadPool::YieldToCriticalTasks()
 	{
-		using return_type = typename std::result_of<F(Args...)>::type;
+		if (m_current_worker.first != this)
+		{
+			return 0;
+		}
+
+		std::size_t num_tasks = 0;
+		while (auto task = PopTask(m_current_worker.second, TaskPriority::FRAME_CRITICAL))
+		{
+			RunTask(m_current_worker.second, task);
+			++num_tasks;
+		}
 
-		auto task = std::make_shared< std::packaged_task<return_type()> >(
-			std::bind(std::forward<F>(f), std::forward<Args>(args)...)
-			);
+		return num_tasks;
+	}
+
+	// Runs a task that was counted as running when it was taken from its lane.
+	// Tasks run by a thread that isn't a worker, see `Submit`, don't have a worker index and aren't included in the worker telemetry.
+	inline void ThreadPool::RunTask(std::optional<std::uint32_t> index, internal::TaskSlot* slot)
+	{
+		const auto lane_index = static_cast<std::size_t>(slot->m_priority);
+		auto& lane = m_lanes[lane_index];
 
-		std::future<return_type> res = task->get_future();
+		if (!index.has_value())
 		{
-			std::unique_lock<std::mutex> lock(m_queue_mutex);
+			slot->m_run(*slot);
 
-			// don't allow enqueueing after stopping the pool
-			if (m_stop)
-				throw std::runtime_error("enqueue on stopped ThreadPool");
+			lane.m_num_running.fetch_sub(1, std::memory_order_relaxed);
+			lane.m_num_completed.fetch_add(1, std::memory_order_relaxed);
 
-			m_tasks.emplace([task]() { (*task)(); });
+			internal::CompleteTaskSlot(*slot);
+			internal::ReleaseTaskSlot(slot);
+			return;
 		}
-		m_condition.notify_one();
-		return res;
+
+		auto& telemetry = m_worker_data[index.value()]->m_telemetry;
+
+#ifndef TP_DISABLE_TELEMETRY
+		const auto begin = clock_t::now();
+		const auto latency = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			clock_t::duration(std::max<clock_t::rep>(begin.time_since_epoch().count() - slot->m_enqueue_time, 0))).count());
+
+		Add(telemetry.m_num_started[lane_index], 1);
+		Add(telemetry.m_total_latency_ns[lane_index], latency);
+		if (latency > telemetry.m_max_latency_ns[lane_index].load(std::memory_order_relaxed))
+		{
+			telemetry.m_max_latency_ns[lane_index].store(latency, std::memory_order_relaxed);
+		}
+		++telemetry.m_depth;
+#endif
+
+		slot->m_run(*slot);
+
+#ifndef TP_DISABLE_TELEMETRY
+		if (--telemetry.m_depth == 0)
+		{
+			Add(telemetry.m_busy_ns, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - begin).count()));
+		}
+#endif
+		Add(telemetry.m_num_tasks, 1);
+
+		lane.m_num_running.fetch_sub(1, std::memory_order_relaxed);
+		lane.m_num_completed.fetch_add(1, std::memory_order_relaxed);
+
+		internal::CompleteTaskSlot(*slot);
+		internal::ReleaseTaskSlot(slot);
 	}
 
-	// the destructor joins all threads
-	inline ThreadPool::~ThreadPool()
+	inline TaskLaneStats ThreadPool::GetLaneStats(TaskPriority priority) const noexcept
 	{
+		const auto lane_index = static_cast<std::size_t>(priority);
+		auto& lane = m_lanes[lane_index];
+
+		TaskLaneStats stats;
+		stats.m_num_queued = lane.m_num_queued.load(std::memory_order_relaxed);
+		stats.m_max_queued = lane.m_max_queued.load(std::memory_order_relaxed);
+		stats.m_num_running = lane.m_num_running.load(std::memory_order_relaxed);
+		stats.m_num_completed = lane.m_num_completed.load(std::memory_order_relaxed);
+
+		std::uint64_t num_started = 0;
+		std::uint64_t total_latency_ns = 0;
+		std::uint64_t max_latency_ns = 0;
+		for (auto const & worker : m_worker_data)
+		{
+			num_started += worker->m_telemetry.m_num_started[lane_index].load(std::memory_order_relaxed);
+			total_latency_ns += worker->m_telemetry.m_total_latency_ns[lane_index].load(std::memory_order_relaxed);
+			max_latency_ns = std::max(max_latency_ns, worker->m_telemetry.m_max_latency_ns[lane_index].load(std::memory_order_relaxed));
+		}
+
+		if (num_started > 0)
 		{
-			std::unique_lock<std::mutex> lock(m_queue_mutex);
-			m_stop = true;
+			stats.m_average_latency_ms = static_cast<double>(total_latency_ns) / static_cast<double>(num_started) / 1e6;
 		}
+		stats.m_max_latency_ms = static_cast<double>(max_latency_ns) / 1e6;
+
+		return stats;
+	}
+
+	inline ThreadPoolStats ThreadPool::GetStats() const
+	{
+		ThreadPoolStats stats;
+		stats.m_uptime_ms = std::chrono::duration<double, std::milli>(clock_t::now() - m_start).count();
+
+		stats.m_workers.reserve(m_worker_data.size());
+		for (auto const & worker : m_worker_data)
+		{
+			auto& telemetry = worker->m_telemetry;
+
+			ThreadPoolWorkerStats worker_stats;
+			worker_stats.m_num_tasks = telemetry.m_num_tasks.load(std::memory_order_relaxed);
+			worker_stats.m_num_steals = telemetry.m_num_steals.load(std::memory_order_relaxed);
+			worker_stats.m_busy_ms = static_cast<double>(telemetry.m_busy_ns.load(std::memory_order_relaxed)) / 1e6;
+			worker_stats.m_idle_ms = std::max(stats.m_uptime_ms - worker_stats.m_busy_ms, 0.0);
+			stats.m_workers.push_back(worker_stats);
+		}
+
+		for (std::size_t i = 0; i < num_priorities; ++i)
+		{
+			stats.m_lanes[i] = GetLaneStats(static_cast<TaskPriority>(i));
+		}
+
+		return stats;
+	}
+
+	inline internal::TaskSlot* ThreadPool::AllocateSlot()
+	{
+		if (auto slot = m_slots->Allocate(); slot)
+		{
+			return slot;
+		}
+
+		// More tasks are alive than the pool has slots for.
+		return new internal::TaskSlot();
+	}
+
+	// the destructor runs the remaining tasks and joins all threads
+	inline ThreadPool::~ThreadPool()
+	{
+		m_stop.store(true, std::memory_order_seq_cst);
+		m_epoch.fetch_add(1, std::memory_order_seq_cst);
+		m_epoch.notify_all();
 
-		m_condition.notify_all();
 		for (std::thread& worker : m_workers)
 		{
 			worker.join();
 		}
+
+		// Slots that are still referenced by a `TaskFuture` keep the block alive.
+		m_slots->Release();
+	}
+
+	//! Converts pool telemetry to JSON for the capacity planning scripts.
+	/*!
+		\param name Stored in the `name` field to tell pools apart.
+	*/
+	inline std::string ThreadPoolStatsToJson(ThreadPoolStats const & stats, std::string const & name)
+	{
+		static const char* lane_names[] = { "frame_critical", "background" };
+		static_assert(std::size(lane_names) == static_cast<std::size_t>(TaskPriority::COUNT));
+
+		std::ostringstream ss;
+		ss << "{\"name\":\"" << name << "\""
+			<< ",\"uptime_ms\":" << stats.m_uptime_ms
+			<< ",\"num_threads\":" << stats.m_workers.size();
+
+		ss << ",\"workers\":[";
+		for (std::size_t i = 0; i < stats.m_workers.size(); ++i)
+		{
+			auto const & worker = stats.m_workers[i];
+			ss << (i == 0 ? "\n" : ",\n")
+				<< "{\"index\":" << i
+				<< ",\"tasks\":" << worker.m_num_tasks
+				<< ",\"steals\":" << worker.m_num_steals
+				<< ",\"busy_ms\":" << worker.m_busy_ms
+				<< ",\"idle_ms\":" << worker.m_idle_ms << "}";
+		}
+		ss << "\n]";
+
+		ss << ",\"lanes\":{";
+		for (std::size_t i = 0; i < stats.m_lanes.size(); ++i)
+		{
+			auto const & lane = stats.m_lanes[i];
+			ss << (i == 0 ? "\n" : ",\n")
+				<< "\"" << lane_names[i] << "\":"
+				<< "{\"queued\":" << lane.m_num_queued
+				<< ",\"max_queued\":" << lane.m_max_queued
+				<< ",\"running\":" << lane.m_num_running
+				<< ",\"completed\":" << lane.m_num_completed
+				<< ",\"average_latency_ms\":" << lane.m_average_latency_ms
+				<< ",\"max_latency_ms\":" << lane.m_max_latency_ms << "}";
+		}
+		ss << "\n}}\n";
+
+		return ss.str();
+	}
+
+	inline bool SaveThreadPoolStats(ThreadPoolStats const & stats, std::string const & name, std::string const & path)
+	{
+		std::ofstream file(path);
+
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		file << ThreadPoolStatsToJson(stats, name);
+
+		return file.good();
 	}
 
-}
\ No newline at end of file
+} /* util */
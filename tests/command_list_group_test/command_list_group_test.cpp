@@ -0,0 +1,138 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "frame_graph/command_list_groups.hpp"
+
+using wr::CommandListGroupingInfo;
+
+static CommandListGroupingInfo Task(std::uint32_t list_type = 0, std::uint32_t submission = 0, bool multithreaded = true, bool mergeable = true)
+{
+	return { list_type, submission, multithreaded, mergeable };
+}
+
+static bool CanShareList(CommandListGroupingInfo const & a, CommandListGroupingInfo const & b)
+{
+	return a.m_mergeable && b.m_mergeable && a.m_list_type == b.m_list_type && a.m_submission == b.m_submission && a.m_multithreaded == b.m_multithreaded;
+}
+
+/*! Checks the groups hold every task once and in order, never mix tasks that can't share a list,
+	respect the limit, and only start a new group when the previous one couldn't take the task. */
+static bool IsValidGrouping(std::vector<CommandListGroupingInfo> const & tasks, std::uint32_t limit, std::vector<std::vector<std::uint32_t>> const & groups)
+{
+	const auto max_size = std::max(limit, 1u);
+	std::uint32_t next_task = 0;
+
+	for (std::size_t g = 0; g < groups.size(); ++g)
+	{
+		auto const & group = groups[g];
+		if (group.empty() || group.size() > max_size)
+		{
+			return false;
+		}
+
+		for (std::size_t i = 0; i < group.size(); ++i)
+		{
+			if (group[i] != next_task++ || (i > 0 && !CanShareList(tasks[group[i - 1]], tasks[group[i]])))
+			{
+				return false;
+			}
+		}
+
+		// Groups are as large as possible.
+		if (g > 0)
+		{
+			auto const & previous = groups[g - 1];
+			if (previous.size() < max_size && CanShareList(tasks[previous.back()], tasks[group.front()]))
+			{
+				return false;
+			}
+		}
+	}
+
+	return next_task == tasks.size();
+}
+
+static bool g_success = true;
+
+static void Expect(char const * name, std::vector<CommandListGroupingInfo> const & tasks, std::uint32_t limit, std::vector<std::vector<std::uint32_t>> const & expected)
+{
+	wr::CommandListCoalescingPolicy policy;
+	policy.m_max_tasks_per_list = limit;
+
+	const auto groups = wr::PlanCommandListGroups(tasks, policy);
+	if (groups != expected || !IsValidGrouping(tasks, limit, groups))
+	{
+		std::printf("%s: unexpected grouping with a limit of %u (%zu groups).\n", name, limit, groups.size());
+		g_success = false;
+	}
+}
+
+int main()
+{
+	const std::vector<CommandListGroupingInfo> five_tasks(5, Task());
+
+	// The limit.
+	Expect("No coalescing", five_tasks, 1, { { 0 }, { 1 }, { 2 }, { 3 }, { 4 } });
+	Expect("A limit of 0 is treated as 1", five_tasks, 0, { { 0 }, { 1 }, { 2 }, { 3 }, { 4 } });
+	Expect("Pairs", five_tasks, 2, { { 0, 1 }, { 2, 3 }, { 4 } });
+	Expect("Triples", five_tasks, 3, { { 0, 1, 2 }, { 3, 4 } });
+	Expect("Limit equal to the task count", five_tasks, 5, { { 0, 1, 2, 3, 4 } });
+	Expect("Limit above the task count", five_tasks, 64, { { 0, 1, 2, 3, 4 } });
+
+	// Tasks that can't share a command list.
+	Expect("Compute between direct tasks", { Task(), Task(), Task(1), Task(1), Task() }, 8, { { 0, 1 }, { 2, 3 }, { 4 } });
+	Expect("New queue submission", { Task(0, 0), Task(0, 1), Task(0, 1) }, 8, { { 0 }, { 1, 2 } });
+	Expect("Main thread task", { Task(), Task(0, 0, false), Task(0, 0, false), Task() }, 8, { { 0 }, { 1, 2 }, { 3 } });
+	Expect("Secondary command lists", { Task(), Task(0, 0, true, false), Task(0, 0, true, false), Task() }, 8, { { 0 }, { 1 }, { 2 }, { 3 } });
+
+	// The limit starts counting again at every split.
+	Expect("Limit after a split", { Task(), Task(1), Task(1), Task(1), Task(), Task() }, 2, { { 0 }, { 1, 2 }, { 3 }, { 4, 5 } });
+
+	// Random task lists with every limit up to 6.
+	std::mt19937 rng(42);
+	for (int i = 0; i < 2000; ++i)
+	{
+		std::vector<CommandListGroupingInfo> tasks(rng() % 24);
+		for (auto& task : tasks)
+		{
+			task = Task(rng() % 2, rng() % 3 == 0 ? 1 : 0, rng() % 8 != 0, rng() % 8 != 0);
+		}
+		// Submissions only increase over the frame.
+		for (std::size_t t = 1; t < tasks.size(); ++t)
+		{
+			tasks[t].m_submission += tasks[t - 1].m_submission;
+		}
+
+		wr::CommandListCoalescingPolicy policy;
+		policy.m_max_tasks_per_list = rng() % 7;
+
+		if (!IsValidGrouping(tasks, policy.m_max_tasks_per_list, wr::PlanCommandListGroups(tasks, policy)))
+		{
+			std::printf("Random task list %d: invalid grouping with a limit of %u.\n", i, policy.m_max_tasks_per_list);
+			g_success = false;
+			break;
+		}
+	}
+
+	std::printf(g_success ? "All command list group tests passed.\n" : "Command list group tests failed.\n");
+
+	return g_success ? 0 : 1;
+}
@@ -166,8 +166,6 @@ int WispEntry()
 			delete current_scene;
 			current_scene = new_scene;
 			current_scene->Init(render_system.get(), window->GetWidth(), window->GetHeight(), &phys_engine);
-			fg_manager::Get()->SetShouldExecute<wr::EquirectToCubemapTaskData>(true);
-			fg_manager::Get()->SetShouldExecute<wr::CubemapConvolutionTaskData>(true);
 		}
 
 		current_scene->Update(delta);
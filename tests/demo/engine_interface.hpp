@@ -157,6 +157,10 @@ namespace engine
 					ImGui::MenuItem("Inspector", nullptr, &wr::imgui::window::open_inspector);
 					ImGui::MenuItem("Hardware Info", nullptr, &wr::imgui::window::open_hardware_info);
 					ImGui::MenuItem("DirectX 12 Settings", nullptr, &wr::imgui::window::open_d3d12_settings);
+#ifdef FG_ENABLE_PROFILING
+					ImGui::MenuItem("Frame Graph Timings", nullptr, &wr::imgui::window::open_frame_graph_timings);
+#endif
+					ImGui::MenuItem("Thread Pool Telemetry", nullptr, &wr::imgui::window::open_thread_pool_telemetry);
 					ImGui::Separator();
 					wr::imgui::menu::Registries();
 					ImGui::Separator();
@@ -321,6 +325,10 @@ namespace engine
 			wr::imgui::window::D3D12HardwareInfo(*render_system);
 			wr::imgui::window::D3D12Settings();
 			wr::imgui::window::GraphicsSettings(fg_manager::Get());
+#ifdef FG_ENABLE_PROFILING
+			wr::imgui::window::FrameGraphTimings(fg_manager::Get()->GetProfiler());
+#endif
+			wr::imgui::window::ThreadPoolTelemetry(fg_manager::Get()->GetThreadPoolStats());
 		}
 	}
 }
@@ -0,0 +1,195 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdio>
+#include <vector>
+
+#include "frame_graph/frame_graph.hpp"
+#include "scene_graph/scene_graph.hpp"
+
+/*! Render system that hands out placeholder command lists and render targets, so the frame graph runs without a GPU. */
+class FakeRenderSystem : public wr::RenderSystem
+{
+public:
+	std::shared_ptr<wr::TexturePool> CreateTexturePool() override { return nullptr; }
+	std::shared_ptr<wr::MaterialPool> CreateMaterialPool(std::size_t) override { return nullptr; }
+	std::shared_ptr<wr::ModelPool> CreateModelPool(std::size_t, std::size_t) override { return nullptr; }
+	std::shared_ptr<wr::ConstantBufferPool> CreateConstantBufferPool(std::size_t) override { return nullptr; }
+	std::shared_ptr<wr::StructuredBufferPool> CreateStructuredBufferPool(std::size_t) override { return nullptr; }
+	std::shared_ptr<wr::TexturePool> GetDefaultTexturePool() override { return nullptr; }
+
+	void PrepareRootSignatureRegistry() override {}
+	void PrepareShaderRegistry() override {}
+	void PreparePipelineRegistry() override {}
+	void PrepareRTPipelineRegistry() override {}
+	void DestroyRootSignatureRegistry() override {}
+	void DestroyShaderRegistry() override {}
+	void DestroyPipelineRegistry() override {}
+	void DestroyRTPipelineRegistry() override {}
+	void WaitForAllPreviousWork() override {}
+
+	wr::CommandList* GetDirectCommandList(unsigned int) override { return NewCommandList(); }
+	wr::CommandList* GetBundleCommandList(unsigned int) override { return NewCommandList(); }
+	wr::CommandList* GetComputeCommandList(unsigned int) override { return NewCommandList(); }
+	wr::CommandList* GetCopyCommandList(unsigned int) override { return NewCommandList(); }
+	void SetCommandListName(wr::CommandList*, std::wstring const &) override {}
+	void DestroyCommandList(wr::CommandList* cmd_list) override { delete reinterpret_cast<int*>(cmd_list); }
+
+	wr::RenderTarget* GetRenderTarget(wr::RenderTargetProperties) override { return reinterpret_cast<wr::RenderTarget*>(new int(0)); }
+	wr::RenderTargetAllocationInfo GetRenderTargetAllocationInfo(wr::RenderTargetProperties) override { return { 0, 0 }; }
+	void SetRenderTargetName(wr::RenderTarget*, std::wstring const &) override {}
+	void ResizeRenderTarget(wr::RenderTarget**, std::uint32_t, std::uint32_t) override {}
+	void DestroyRenderTarget(wr::RenderTarget** render_target) override { delete reinterpret_cast<int*>(*render_target); *render_target = nullptr; }
+
+	void ResetCommandList(wr::CommandList*) override {}
+	void CloseCommandList(wr::CommandList*) override {}
+	void StartRenderTask(wr::CommandList*, std::pair<wr::RenderTarget*, wr::RenderTargetProperties>) override {}
+	void StopRenderTask(wr::CommandList*, std::pair<wr::RenderTarget*, wr::RenderTargetProperties>) override {}
+	void ContinueRenderTask(wr::CommandList*, std::pair<wr::RenderTarget*, wr::RenderTargetProperties>) override {}
+	void StartComputeTask(wr::CommandList*, std::pair<wr::RenderTarget*, wr::RenderTargetProperties>) override {}
+	void StopComputeTask(wr::CommandList*, std::pair<wr::RenderTarget*, wr::RenderTargetProperties>) override {}
+	void StartCopyTask(wr::CommandList*, std::pair<wr::RenderTarget*, wr::RenderTargetProperties>) override {}
+	void StopCopyTask(wr::CommandList*, std::pair<wr::RenderTarget*, wr::RenderTargetProperties>) override {}
+	void RecordResourceBarriers(wr::CommandList*, std::vector<wr::ResourceBarrier> const &) override {}
+
+	void Init(std::optional<wr::Window*>) override {}
+	wr::CPUTextures Render(wr::SceneGraph&, wr::FrameGraph&) override { return {}; }
+	void Resize(std::uint32_t, std::uint32_t) override {}
+	unsigned int GetFrameIdx() override { return 0; }
+	void RequestSkyboxReload() override {}
+	wr::Model* GetSimpleShape(SimpleShapes) override { return nullptr; }
+
+protected:
+	void SaveRenderTargetToDisc(std::string const &, wr::RenderTarget*, unsigned int) override {}
+
+private:
+	static wr::CommandList* NewCommandList()
+	{
+		return reinterpret_cast<wr::CommandList*>(new int(0));
+	}
+};
+
+struct ProducerData {};
+struct ConsumerData {};
+struct LooseData {};
+struct MissingData {};
+
+static bool g_success = true;
+static std::vector<bool> g_executed;
+
+static void Check(bool condition, char const * what)
+{
+	if (!condition)
+	{
+		std::printf("Failed: %s\n", what);
+		g_success = false;
+	}
+}
+
+/*! A task that records whether it executed. Runs on the main thread, so `g_executed` doesn't need a lock. */
+static wr::RenderTaskDesc TaskDesc()
+{
+	wr::RenderTaskDesc desc;
+	desc.m_setup_func = [](wr::RenderSystem&, wr::FrameGraph&, wr::RenderTaskHandle, bool) {};
+	desc.m_execute_func = [](wr::RenderSystem&, wr::FrameGraph&, wr::SceneGraph&, wr::RenderTaskHandle handle)
+	{
+		g_executed[handle] = true;
+	};
+	desc.m_destroy_func = [](wr::FrameGraph&, wr::RenderTaskHandle, bool) {};
+	desc.m_allow_multithreading = false;
+	return desc;
+}
+
+template<typename T>
+static void AddTask(wr::FrameGraph& frame_graph, std::vector<std::reference_wrapper<const std::type_info>> dependencies = {})
+{
+	auto desc = TaskDesc();
+	frame_graph.AddTask<T>(desc, L"Edit Test Task", dependencies);
+}
+
+/*! Execute a frame and return which tasks recorded. */
+static std::vector<bool> ExecuteFrame(wr::FrameGraph& frame_graph, wr::SceneGraph& scene_graph, std::size_t num_tasks)
+{
+	g_executed.assign(num_tasks, false);
+	frame_graph.Execute(scene_graph);
+	(void)frame_graph.GetAllCommandLists<wr::CommandList>();
+	return g_executed;
+}
+
+static void TestRemovingADependencyIsRejected(FakeRenderSystem& render_system, wr::SceneGraph& scene_graph)
+{
+	wr::FrameGraph frame_graph(2);
+	AddTask<ProducerData>(frame_graph);
+	AddTask<ConsumerData>(frame_graph, FG_DEPS<ProducerData>());
+	frame_graph.Setup(render_system);
+
+	frame_graph.RemoveTask<ProducerData>();
+	Check(frame_graph.HasTask<ProducerData>(), "a task named with FG_DEPS by a later task is kept");
+	Check(ExecuteFrame(frame_graph, scene_graph, 2) == std::vector<bool>{ true, true }, "both tasks still execute after the rejected removal");
+
+	// Removing the dependent first makes the producer removable.
+	frame_graph.RemoveTask<ConsumerData>();
+	frame_graph.RemoveTask<ProducerData>();
+	Check(!frame_graph.HasTask<ConsumerData>() && !frame_graph.HasTask<ProducerData>(), "tasks are removed in reverse dependency order");
+}
+
+static void TestReplacingADependencyIsAllowed(FakeRenderSystem& render_system, wr::SceneGraph& scene_graph)
+{
+	wr::FrameGraph frame_graph(2);
+	AddTask<ProducerData>(frame_graph);
+	AddTask<ConsumerData>(frame_graph, FG_DEPS<ProducerData>());
+	frame_graph.Setup(render_system);
+
+	auto desc = TaskDesc();
+	frame_graph.ReplaceTask<ProducerData>(desc, L"Replaced Producer");
+
+	Check(frame_graph.HasTask<ProducerData>(), "the replaced task is in the frame graph");
+	Check(ExecuteFrame(frame_graph, scene_graph, 2) == std::vector<bool>{ true, true }, "the dependent of a replaced task is set up again and executes");
+}
+
+/*! Validation only runs when `FG_MAX_PERFORMANCE` isn't defined, in release builds the setup can't fail. */
+static void TestFailedSetupExecutesNothing(FakeRenderSystem& render_system, wr::SceneGraph& scene_graph)
+{
+	wr::FrameGraph frame_graph(3);
+	AddTask<ProducerData>(frame_graph);
+	AddTask<ConsumerData>(frame_graph, FG_DEPS<ProducerData>());
+	frame_graph.Setup(render_system);
+	Check(ExecuteFrame(frame_graph, scene_graph, 2) == std::vector<bool>{ true, true }, "a valid frame graph executes");
+
+	// The dependency doesn't exist, so setting up the new task fails validation.
+	AddTask<LooseData>(frame_graph, FG_DEPS<MissingData>());
+	Check(ExecuteFrame(frame_graph, scene_graph, 3) == std::vector<bool>{ false, false, false }, "no task executes after a failed setup");
+	Check(frame_graph.GetAllCommandLists<wr::CommandList>().empty(), "no command lists are submitted after a failed setup");
+
+	// Fixing the frame graph lets it execute again.
+	frame_graph.RemoveTask<LooseData>();
+	Check(ExecuteFrame(frame_graph, scene_graph, 2) == std::vector<bool>{ true, true }, "the frame graph executes again once it's valid");
+}
+
+int main()
+{
+	FakeRenderSystem render_system;
+	wr::SceneGraph scene_graph(&render_system);
+
+	TestRemovingADependencyIsRejected(render_system, scene_graph);
+	TestReplacingADependencyIsAllowed(render_system, scene_graph);
+#ifndef FG_MAX_PERFORMANCE
+	TestFailedSetupExecutesNothing(render_system, scene_graph);
+#endif
+
+	std::printf(g_success ? "All frame graph edit tests passed.\n" : "Frame graph edit tests failed.\n");
+
+	return g_success ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "util/parallel.hpp"
+
+static const std::size_t num_nodes = 1'000'000;
+static const std::size_t num_triangles = 1'000'000;
+static const std::size_t num_sort_keys = 4'000'000;
+static const unsigned int num_repetitions = 5;
+static const std::size_t thread_counts[] = { 1, 2, 4, 8, 16 };
+
+struct Box
+{
+	std::array<float, 3> m_min;
+	std::array<float, 3> m_max;
+};
+
+struct Transform
+{
+	std::array<float, 16> m_matrix;
+};
+
+/*! Same work as `AABB::FromTransform` in `Update_MeshNodes`: transform the 8 corners of a box and take the bounds. */
+static Box TransformBox(Box const & box, Transform const & transform)
+{
+	Box result = { { INFINITY, INFINITY, INFINITY }, { -INFINITY, -INFINITY, -INFINITY } };
+	auto& m = transform.m_matrix;
+
+	for (int corner = 0; corner < 8; ++corner)
+	{
+		const float x = corner & 1 ? box.m_max[0] : box.m_min[0];
+		const float y = corner & 2 ? box.m_max[1] : box.m_min[1];
+		const float z = corner & 4 ? box.m_max[2] : box.m_min[2];
+
+		for (int i = 0; i < 3; ++i)
+		{
+			const float value = x * m[i] + y * m[4 + i] + z * m[8 + i] + m[12 + i];
+			result.m_min[i] = std::min(result.m_min[i], value);
+			result.m_max[i] = std::max(result.m_max[i], value);
+		}
+	}
+
+	return result;
+}
+
+/*! Same work as one triangle of `ComputeTangents` in the glTF loader. */
+static std::array<float, 3> ComputeTangent(std::array<float, 5> const * v)
+{
+	const float e1[3] = { v[1][0] - v[0][0], v[1][1] - v[0][1], v[1][2] - v[0][2] };
+	const float e2[3] = { v[2][0] - v[0][0], v[2][1] - v[0][1], v[2][2] - v[0][2] };
+	const float uv1[2] = { v[1][3] - v[0][3], v[1][4] - v[0][4] };
+	const float uv2[2] = { v[2][3] - v[0][3], v[2][4] - v[0][4] };
+	const float r = 1.0f / (uv1[0] * uv2[1] - uv1[1] * uv2[0]);
+
+	return { (e1[0] * uv2[1] - e2[0] * uv1[1]) * r, (e1[1] * uv2[1] - e2[1] * uv1[1]) * r, (e1[2] * uv2[1] - e2[2] * uv1[1]) * r };
+}
+
+template<typename F>
+static double Measure(F const & func)
+{
+	double best = 1e30;
+	for (unsigned int i = 0; i < num_repetitions; ++i)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		func();
+		const auto end = std::chrono::high_resolution_clock::now();
+		best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+	}
+	return best;
+}
+
+int main()
+{
+	std::mt19937 rng(1337);
+	std::uniform_real_distribution<float> dist(-100.f, 100.f);
+
+	std::vector<Box> boxes(num_nodes);
+	std::vector<Transform> transforms(num_nodes);
+	for (std::size_t i = 0; i < num_nodes; ++i)
+	{
+		boxes[i] = { { -1.f, -1.f, -1.f }, { 1.f, 1.f, 1.f } };
+		for (auto& value : transforms[i].m_matrix)
+		{
+			value = dist(rng);
+		}
+	}
+
+	std::vector<std::array<float, 5>> vertices(num_triangles * 3);
+	for (auto& vertex : vertices)
+	{
+		for (auto& value : vertex)
+		{
+			value = dist(rng);
+		}
+	}
+
+	std::vector<std::uint64_t> keys(num_sort_keys);
+	for (auto& key : keys)
+	{
+		key = (static_cast<std::uint64_t>(rng()) << 32) | rng();
+	}
+
+	std::vector<Box> out_boxes(num_nodes);
+	std::vector<std::array<float, 3>> out_tangents(num_triangles);
+	std::vector<std::uint64_t> sorted_keys;
+
+	std::printf("Best of %u runs. Thread count includes the calling thread.\n", num_repetitions);
+	std::printf("%-20s %8s %12s %10s\n", "Benchmark", "Threads", "Time (ms)", "Speedup");
+
+	auto report = [](char const * name, std::size_t num_threads, double ms, double serial_ms)
+	{
+		std::printf("%-20s %8zu %12.2f %9.2fx\n", name, num_threads, ms, serial_ms / ms);
+	};
+
+	double serial_aabb = 0, serial_tangents = 0, serial_reduce = 0, serial_sort = 0;
+	double first_sum = 0;
+
+	for (auto num_threads : thread_counts)
+	{
+		util::ThreadPool pool(num_threads - 1);
+
+		const auto aabb_ms = Measure([&]
+		{
+			util::ParallelFor(pool, 0, num_nodes, 4096, [&](std::size_t i)
+			{
+				out_boxes[i] = TransformBox(boxes[i], transforms[i]);
+			});
+		});
+
+		const auto tangents_ms = Measure([&]
+		{
+			util::ParallelFor(pool, 0, num_triangles, 4096, [&](std::size_t i)
+			{
+				out_tangents[i] = ComputeTangent(&vertices[i * 3]);
+			});
+		});
+
+		double sum = 0;
+		const auto reduce_ms = Measure([&]
+		{
+			sum = util::ParallelReduce(pool, 0, num_nodes, 16384, 0.0, [&](util::IndexRange range, double value)
+			{
+				for (auto i = range.m_begin; i < range.m_end; ++i)
+				{
+					value += out_boxes[i].m_max[0] - out_boxes[i].m_min[0];
+				}
+				return value;
+			}, [](double a, double b) { return a + b; });
+		});
+
+		const auto sort_ms = Measure([&]
+		{
+			sorted_keys = keys;
+			util::ParallelSort(pool, sorted_keys.begin(), sorted_keys.end(), 65536);
+		});
+
+		if (num_threads == 1)
+		{
+			serial_aabb = aabb_ms;
+			serial_tangents = tangents_ms;
+			serial_reduce = reduce_ms;
+			serial_sort = sort_ms;
+			first_sum = sum;
+		}
+
+		if (sum != first_sum || !std::is_sorted(sorted_keys.begin(), sorted_keys.end()))
+		{
+			std::printf("Results differ from the single threaded run.\n");
+			return 1;
+		}
+
+		report("AABB recompute", num_threads, aabb_ms, serial_aabb);
+		report("Tangents", num_threads, tangents_ms, serial_tangents);
+		report("Reduce", num_threads, reduce_ms, serial_reduce);
+		report("Sort", num_threads, sort_ms, serial_sort);
+	}
+
+	return 0;
+}
@@ -0,0 +1,164 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "frame_graph/queue_submissions.hpp"
+
+/*! A synthetic frame graph. */
+struct Graph
+{
+	std::vector<bool> m_compute;
+	std::vector<std::vector<std::uint32_t>> m_dependencies;
+};
+
+/*! Parses a graph like "g c:0 g:0,1". Every task is a `g`raphics or `c`ompute task followed by its dependencies. */
+static Graph ParseGraph(std::string const & description)
+{
+	Graph graph;
+	std::istringstream stream(description);
+	std::string task;
+
+	while (stream >> task)
+	{
+		graph.m_compute.push_back(task[0] == 'c');
+		graph.m_dependencies.emplace_back();
+
+		if (auto colon = task.find(':'); colon != std::string::npos)
+		{
+			std::istringstream dependencies(task.substr(colon + 1));
+			std::string dependency;
+			while (std::getline(dependencies, dependency, ','))
+			{
+				graph.m_dependencies.back().push_back(static_cast<std::uint32_t>(std::stoul(dependency)));
+			}
+		}
+	}
+
+	return graph;
+}
+
+/*! Same mapping as `FrameGraph::GetSubmissionQueue`: without async compute every task goes to the direct queue. */
+static std::vector<wr::SubmissionQueue> GetQueues(Graph const & graph, bool use_async_compute)
+{
+	std::vector<wr::SubmissionQueue> queues;
+	for (bool compute : graph.m_compute)
+	{
+		queues.push_back(use_async_compute && compute ? wr::SubmissionQueue::COMPUTE : wr::SubmissionQueue::DIRECT);
+	}
+	return queues;
+}
+
+/*! Formats a plan like "D(0)* C(1)<0 end<1". `<n` waits for submission n, `*` signals a fence, `end<n` is the wait at the end of the frame. */
+static std::string FormatPlan(wr::QueueSubmissionPlan const & plan)
+{
+	std::string result;
+
+	for (auto const & submission : plan.m_submissions)
+	{
+		result += result.empty() ? "" : " ";
+		result += submission.m_queue == wr::SubmissionQueue::DIRECT ? "D(" : "C(";
+		for (std::size_t i = 0; i < submission.m_tasks.size(); ++i)
+		{
+			result += (i ? "," : "") + std::to_string(submission.m_tasks[i]);
+		}
+		result += ")";
+		result += submission.m_wait_for.has_value() ? "<" + std::to_string(submission.m_wait_for.value()) : "";
+		result += submission.m_signal ? "*" : "";
+	}
+
+	if (plan.m_wait_at_end.has_value())
+	{
+		result += " end<" + std::to_string(plan.m_wait_at_end.value());
+	}
+
+	return result;
+}
+
+static std::uint32_t CountWaits(wr::QueueSubmissionPlan const & plan)
+{
+	std::uint32_t waits = plan.m_wait_at_end.has_value() ? 1u : 0u;
+	for (auto const & submission : plan.m_submissions)
+	{
+		waits += submission.m_wait_for.has_value() ? 1u : 0u;
+	}
+	return waits;
+}
+
+struct Case
+{
+	char const * m_graph;
+	/*! The expected plan with `settings::use_async_compute` enabled. */
+	char const * m_async_plan;
+};
+
+int main()
+{
+	const Case cases[] =
+	{
+		{ "g g:0", "D(0,1)" },
+		// Compute work nothing depends on is still finished before the frame ends.
+		{ "g c g", "D(0,2) C(1)* end<1" },
+		{ "g c:0", "D(0)* C(1)<0* end<1" },
+		// The direct queue already waited for the last compute submission, no wait at the end.
+		{ "c g:0", "C(0)* D(1)<0" },
+		// Several readers of the same submission share one fence.
+		{ "c g:0 g:0", "C(0)* D(1,2)<0" },
+		// A reader of several tasks in one submission waits once.
+		{ "c c g:0,1", "C(0,1)* D(2)<0" },
+		// Waiting for the latest submission covers the earlier one on the same queue.
+		{ "c g:0 c g:2,0", "C(0)* D(1)<0 C(2)* D(3)<2" },
+		// A submission that signaled is closed, later work on its queue starts a new one.
+		{ "g c:0 g", "D(0)* C(1)<0* D(2) end<1" },
+		{ "g c:0 g:1 c:2", "D(0)* C(1)<0* D(2)<1* C(3)<2* end<3" },
+	};
+
+	bool success = true;
+
+	for (auto const & test_case : cases)
+	{
+		const auto graph = ParseGraph(test_case.m_graph);
+
+		// Without async compute every task is in one direct submission and no fences are needed.
+		std::string sync_plan = "D(";
+		for (std::size_t i = 0; i < graph.m_compute.size(); ++i)
+		{
+			sync_plan += (i ? "," : "") + std::to_string(i);
+		}
+		sync_plan += ")";
+
+		for (bool use_async_compute : { true, false })
+		{
+			const auto plan = wr::PlanQueueSubmissions(GetQueues(graph, use_async_compute), graph.m_dependencies);
+			const auto actual = FormatPlan(plan);
+			const std::string expected = use_async_compute ? test_case.m_async_plan : sync_plan;
+
+			if (actual != expected || plan.m_num_waits != CountWaits(plan))
+			{
+				std::printf("\"%s\" with async compute %s: expected \"%s\", got \"%s\" with %u waits.\n",
+					test_case.m_graph, use_async_compute ? "on" : "off", expected.c_str(), actual.c_str(), plan.m_num_waits);
+				success = false;
+			}
+		}
+	}
+
+	std::printf(success ? "All queue submission tests passed.\n" : "Queue submission tests failed.\n");
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "frame_graph/render_target_aliasing.hpp"
+
+static const std::uint64_t mb = 1024ull * 1024ull;
+
+static bool Check(bool condition, char const * test, char const * message)
+{
+	if (!condition)
+	{
+		std::printf("%s: %s\n", test, message);
+	}
+	return condition;
+}
+
+static wr::RenderTargetLifetime Lifetime(std::uint32_t handle, std::uint64_t size, std::uint32_t first_use, std::uint32_t last_use, std::uint64_t alignment = 64 * 1024)
+{
+	wr::RenderTargetLifetime lifetime;
+	lifetime.m_handle = handle;
+	lifetime.m_size_in_bytes = size;
+	lifetime.m_alignment = alignment;
+	lifetime.m_first_use = first_use;
+	lifetime.m_last_use = last_use;
+	return lifetime;
+}
+
+static bool Intersect(wr::RenderTargetAllocation const & a, wr::RenderTargetAllocation const & b)
+{
+	return a.m_offset < b.m_offset + b.m_size_in_bytes && b.m_offset < a.m_offset + a.m_size_in_bytes;
+}
+
+/*! Render targets that are alive at the same time may never share memory, however the planner placed them. */
+static bool NoLiveTargetsShareMemory(std::vector<wr::RenderTargetLifetime> const & lifetimes, wr::RenderTargetAliasingPlan const & plan)
+{
+	for (std::size_t i = 0; i < lifetimes.size(); ++i)
+	{
+		auto const & a = plan.m_allocations[i];
+		if (a.m_offset % lifetimes[i].m_alignment != 0 || a.m_offset + a.m_size_in_bytes > plan.m_heap_size)
+		{
+			return false;
+		}
+
+		for (std::size_t j = i + 1; j < lifetimes.size(); ++j)
+		{
+			const bool alive_together = lifetimes[i].m_first_use <= lifetimes[j].m_last_use && lifetimes[j].m_first_use <= lifetimes[i].m_last_use;
+			if (alive_together && Intersect(a, plan.m_allocations[j]))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/*! A bloom chain: the targets of the first and third pass are never alive together and share memory. */
+static bool TestDisjointLifetimesShareMemory()
+{
+	const std::vector<wr::RenderTargetLifetime> lifetimes = { Lifetime(0, 8 * mb, 0, 1), Lifetime(1, 8 * mb, 1, 2), Lifetime(2, 8 * mb, 2, 3) };
+	const auto plan = wr::PlanRenderTargetAliasing(lifetimes);
+
+	return Check(plan.m_allocations[0].m_offset == plan.m_allocations[2].m_offset, __func__, "the first and last target should share an offset")
+		&& Check(plan.m_allocations[0].m_offset != plan.m_allocations[1].m_offset, __func__, "the first two targets overlap and can't share an offset")
+		&& Check(plan.m_heap_size == 16 * mb, __func__, "the heap should hold two targets")
+		&& Check(plan.m_unaliased_size == 24 * mb, __func__, "the unaliased size should hold all three targets");
+}
+
+/*! Lifetimes are inclusive: a target written by task 2 and one read by task 2 are alive at the same time. */
+static bool TestTouchingLifetimesOverlap()
+{
+	const std::vector<wr::RenderTargetLifetime> lifetimes = { Lifetime(0, 4 * mb, 0, 2), Lifetime(1, 4 * mb, 2, 4) };
+	const auto plan = wr::PlanRenderTargetAliasing(lifetimes);
+
+	return Check(!Intersect(plan.m_allocations[0], plan.m_allocations[1]), __func__, "targets used by the same task must not alias")
+		&& Check(plan.m_heap_size == 8 * mb, __func__, "the heap should hold both targets");
+}
+
+/*! The memory of a target that died is reused while a longer lived target stays in place next to it. */
+static bool TestReuseNextToLiveTarget()
+{
+	const std::vector<wr::RenderTargetLifetime> lifetimes =
+	{
+		Lifetime(0, 4 * mb, 0, 3), // Alive for the whole frame.
+		Lifetime(1, 4 * mb, 0, 0), // Dies after the first task.
+		Lifetime(2, 2 * mb, 1, 2), // Fits in the memory of the second target.
+	};
+	const auto plan = wr::PlanRenderTargetAliasing(lifetimes);
+
+	return Check(plan.m_allocations[2].m_offset == plan.m_allocations[1].m_offset, __func__, "the third target should reuse the memory of the second")
+		&& Check(plan.m_heap_size == 8 * mb, __func__, "the heap shouldn't grow for the third target");
+}
+
+/*! A small target that's alive next to two others is placed after both, aligned to its own alignment. */
+static bool TestAlignmentOfGaps()
+{
+	const std::vector<wr::RenderTargetLifetime> lifetimes = { Lifetime(0, 100, 0, 0, 64), Lifetime(1, 10, 0, 0, 256) };
+	const auto plan = wr::PlanRenderTargetAliasing(lifetimes);
+
+	return Check(plan.m_allocations[0].m_offset == 0, __func__, "the larger target should be placed first")
+		&& Check(plan.m_allocations[1].m_offset == 256, __func__, "the second target should be aligned to 256 bytes")
+		&& Check(plan.m_heap_size == 266, __func__, "the heap should end after the aligned second target");
+}
+
+/*! Random lifetimes. Only the invariants are checked since the layout depends on the placement order. */
+static bool TestRandomLifetimes()
+{
+	std::mt19937 rng(1337);
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		std::vector<wr::RenderTargetLifetime> lifetimes(rng() % 32);
+		for (std::uint32_t handle = 0; handle < lifetimes.size(); ++handle)
+		{
+			const auto first_use = static_cast<std::uint32_t>(rng() % 32);
+			lifetimes[handle] = Lifetime(handle, (rng() % 16 + 1) * mb / 4, first_use, first_use + rng() % 8, 1ull << (rng() % 17));
+		}
+
+		const auto plan = wr::PlanRenderTargetAliasing(lifetimes);
+		if (!Check(plan.m_allocations.size() == lifetimes.size() && NoLiveTargetsShareMemory(lifetimes, plan), __func__, "targets that are alive at the same time share memory"))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main()
+{
+	bool success = true;
+	success &= TestDisjointLifetimesShareMemory();
+	success &= TestTouchingLifetimesOverlap();
+	success &= TestReuseNextToLiveTarget();
+	success &= TestAlignmentOfGaps();
+	success &= TestRandomLifetimes();
+
+	std::printf(success ? "All render target aliasing tests passed.\n" : "Render target aliasing tests failed.\n");
+
+	return success ? 0 : 1;
+}
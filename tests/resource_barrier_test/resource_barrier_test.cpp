@@ -0,0 +1,231 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "frame_graph/resource_barriers.hpp"
+
+using wr::ResourceBarrier;
+using wr::ResourceBarrierSplit;
+
+// Synthetic resource states. Like the D3D12 states the read states can be combined into one state, the write states can't.
+static const std::uint32_t srv = 1u << 0;
+static const std::uint32_t copy_source = 1u << 1;
+static const std::uint32_t render_target = 1u << 2;
+static const std::uint32_t uav = 1u << 3;
+static const std::uint32_t read_only_states = srv | copy_source;
+
+static const std::uint64_t gbuffer = 1;
+static const std::uint64_t hdr = 2;
+
+/*! Collects the usages of a synthetic frame. */
+struct SyntheticFrame
+{
+	std::uint32_t m_num_tasks = 0;
+	std::vector<wr::ResourceUsage> m_usages;
+	std::vector<wr::ResourceInitialState> m_initial_states;
+	std::vector<wr::SubmissionQueue> m_queues;
+
+	SyntheticFrame& Use(std::uint32_t task, std::uint64_t resource, std::uint32_t state)
+	{
+		m_usages.push_back({ task, resource, state });
+		m_num_tasks = std::max(m_num_tasks, task + 1u);
+		return *this;
+	}
+
+	SyntheticFrame& Initial(std::uint64_t resource, std::uint32_t state)
+	{
+		m_initial_states.push_back({ resource, state });
+		return *this;
+	}
+
+	SyntheticFrame& Queues(std::vector<wr::SubmissionQueue> queues)
+	{
+		m_queues = std::move(queues);
+		return *this;
+	}
+
+	wr::ResourceBarrierPlan Plan(std::uint32_t num_tasks = 0) const
+	{
+		return wr::PlanResourceBarriers(num_tasks ? num_tasks : m_num_tasks, m_usages, m_initial_states, read_only_states, m_queues);
+	}
+};
+
+static bool g_success = true;
+
+static void Expect(bool condition, char const * test, char const * message)
+{
+	if (!condition)
+	{
+		std::printf("%s: %s\n", test, message);
+		g_success = false;
+	}
+}
+
+/*! Whether `barriers` holds exactly the given barrier for the resource, and no other barrier of that resource. */
+static bool HasOnly(std::vector<ResourceBarrier> const & barriers, std::uint64_t resource, std::uint32_t from, std::uint32_t to, ResourceBarrierSplit split = ResourceBarrierSplit::NONE)
+{
+	std::size_t matches = 0;
+	for (auto const & barrier : barriers)
+	{
+		if (barrier.m_resource != resource)
+		{
+			continue;
+		}
+		if (barrier.m_from != from || barrier.m_to != to || barrier.m_split != split)
+		{
+			return false;
+		}
+		matches++;
+	}
+	return matches == 1;
+}
+
+static bool IsEmpty(std::vector<std::vector<ResourceBarrier>> const & lists)
+{
+	for (auto const & list : lists)
+	{
+		if (!list.empty())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/*! G-buffer pass writes, lighting reads, the frame ends in the first state again. */
+static void TestWriteThenRead()
+{
+	const auto plan = SyntheticFrame().Use(0, gbuffer, render_target).Use(1, gbuffer, srv).Plan();
+
+	Expect(plan.m_before[0].empty(), __func__, "the first usage defines the frame state, no barrier expected");
+	Expect(HasOnly(plan.m_before[1], gbuffer, render_target, srv), __func__, "expected render target -> srv before the read");
+	Expect(HasOnly(plan.m_after[1], gbuffer, srv, render_target), __func__, "expected the frame state to be restored after the read");
+	Expect(plan.m_num_barriers == 2, __func__, "expected 2 barriers");
+}
+
+/*! A resource that starts the frame readable is written and transitioned back. */
+static void TestReadThenWrite()
+{
+	const auto plan = SyntheticFrame().Initial(hdr, srv).Use(0, hdr, srv).Use(1, hdr, uav).Plan();
+
+	Expect(plan.m_before[0].empty(), __func__, "the resource is already readable");
+	Expect(HasOnly(plan.m_before[1], hdr, srv, uav), __func__, "expected srv -> uav before the write");
+	Expect(HasOnly(plan.m_after[1], hdr, uav, srv), __func__, "expected uav -> srv at the end of the frame");
+}
+
+/*! Consecutive readers in different read states share one combined state instead of transitioning between reads. */
+static void TestReadStatesAreMerged()
+{
+	const auto plan = SyntheticFrame()
+		.Initial(hdr, render_target)
+		.Use(0, hdr, srv)
+		.Use(1, hdr, copy_source)
+		.Use(2, hdr, srv)
+		.Plan();
+
+	Expect(HasOnly(plan.m_before[0], hdr, render_target, srv | copy_source), __func__, "expected a single transition to the combined read state");
+	Expect(plan.m_before[1].empty() && plan.m_before[2].empty(), __func__, "no barriers expected between the reads");
+	Expect(HasOnly(plan.m_after[2], hdr, srv | copy_source, render_target), __func__, "expected the initial state to be restored");
+	Expect(plan.m_num_barriers == 2 && plan.m_num_unmerged_barriers == 4, __func__, "merging should save two barriers");
+}
+
+/*! A write between two reads separates them, the reads before and after aren't combined. */
+static void TestWriteSeparatesReads()
+{
+	const auto plan = SyntheticFrame().Use(0, hdr, srv).Use(1, hdr, uav).Use(2, hdr, copy_source).Plan();
+
+	Expect(HasOnly(plan.m_before[1], hdr, srv, uav), __func__, "expected srv -> uav");
+	Expect(HasOnly(plan.m_before[2], hdr, uav, copy_source), __func__, "expected uav -> copy source, not a combined state");
+	Expect(HasOnly(plan.m_after[2], hdr, copy_source, srv), __func__, "expected copy source -> srv at the end of the frame");
+}
+
+/*! A task declaring the same resource more than once gets one barrier. A write wins over reads, reads are combined. */
+static void TestMultipleDeclarationsInOneTask()
+{
+	const auto write = SyntheticFrame().Initial(hdr, srv).Use(0, hdr, srv).Use(0, hdr, uav).Use(0, hdr, srv).Plan();
+	Expect(HasOnly(write.m_before[0], hdr, srv, uav), __func__, "a read and a write in one task should use the write state");
+
+	const auto reads = SyntheticFrame().Initial(hdr, render_target).Use(0, hdr, srv).Use(0, hdr, copy_source).Use(0, hdr, srv).Plan();
+	Expect(HasOnly(reads.m_before[0], hdr, render_target, srv | copy_source), __func__, "two reads in one task should be combined");
+
+	const auto same = SyntheticFrame().Use(0, hdr, uav).Use(1, hdr, uav).Use(1, hdr, uav).Use(2, hdr, uav).Plan();
+	Expect(IsEmpty(same.m_before) && IsEmpty(same.m_after) && same.m_num_barriers == 0, __func__, "repeated states shouldn't produce barriers");
+}
+
+/*! Tasks that don't touch the resource execute between the producer and consumer, so the transition is split over them. */
+static void TestSplitBarriers()
+{
+	const auto split = SyntheticFrame().Use(0, gbuffer, render_target).Use(3, gbuffer, srv).Plan();
+
+	Expect(HasOnly(split.m_after[0], gbuffer, render_target, srv, ResourceBarrierSplit::BEGIN), __func__, "expected the transition to begin after the producer");
+	Expect(HasOnly(split.m_before[3], gbuffer, render_target, srv, ResourceBarrierSplit::END), __func__, "expected the transition to end before the consumer");
+	Expect(split.m_num_barriers == 2, __func__, "a split barrier counts once");
+
+	const auto adjacent = SyntheticFrame().Use(0, gbuffer, render_target).Use(1, gbuffer, srv).Plan();
+	Expect(HasOnly(adjacent.m_before[1], gbuffer, render_target, srv), __func__, "adjacent tasks don't need a split barrier");
+}
+
+/*! A split barrier can't begin on one queue and end on the other. */
+static void TestSplitBarriersStayOnOneQueue()
+{
+	const auto direct = wr::SubmissionQueue::DIRECT;
+	const auto compute = wr::SubmissionQueue::COMPUTE;
+
+	const auto cross = SyntheticFrame().Use(0, hdr, render_target).Use(3, hdr, srv).Queues({ direct, direct, direct, compute }).Plan();
+	Expect(cross.m_after[0].empty(), __func__, "the transition shouldn't begin on the direct queue");
+	Expect(HasOnly(cross.m_before[3], hdr, render_target, srv), __func__, "expected a full barrier on the compute queue");
+
+	const auto same = SyntheticFrame().Use(0, hdr, uav).Use(3, hdr, srv).Queues({ compute, direct, direct, compute }).Plan();
+	Expect(HasOnly(same.m_after[0], hdr, uav, srv, ResourceBarrierSplit::BEGIN), __func__, "tasks on the same queue can still split the transition");
+}
+
+/*! Resources are planned independently. Every resource gets its own barrier in a task's list. */
+static void TestIndependentResources()
+{
+	const auto plan = SyntheticFrame().Use(0, gbuffer, render_target).Use(0, hdr, srv).Use(1, gbuffer, srv).Use(1, hdr, uav).Plan();
+
+	Expect(plan.m_before[1].size() == 2, __func__, "expected one barrier per resource");
+	Expect(HasOnly(plan.m_before[1], gbuffer, render_target, srv) && HasOnly(plan.m_before[1], hdr, srv, uav), __func__, "unexpected barriers before the second task");
+}
+
+/*! Usages of culled tasks are ignored. */
+static void TestCulledTasksAreIgnored()
+{
+	const auto plan = SyntheticFrame().Use(0, hdr, uav).Use(1, hdr, srv).Plan(1);
+
+	Expect(plan.m_before.size() == 1 && IsEmpty(plan.m_before) && IsEmpty(plan.m_after), __func__, "the usage of the culled task shouldn't produce barriers");
+}
+
+int main()
+{
+	TestWriteThenRead();
+	TestReadThenWrite();
+	TestReadStatesAreMerged();
+	TestWriteSeparatesReads();
+	TestMultipleDeclarationsInOneTask();
+	TestSplitBarriers();
+	TestSplitBarriersStayOnOneQueue();
+	TestIndependentResources();
+	TestCulledTasksAreIgnored();
+
+	std::printf(g_success ? "All resource barrier tests passed.\n" : "Resource barrier tests failed.\n");
+
+	return g_success ? 0 : 1;
+}
@@ -0,0 +1,224 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "util/thread_pool.hpp"
+
+static const std::size_t num_tasks = 200'000;
+static const std::size_t num_children = 16;
+static const unsigned int num_repetitions = 5;
+static const std::size_t thread_counts[] = { 4, 8, 16, 32 };
+
+/*! The previous thread pool. A single queue guarded by a mutex, used as the baseline. */
+class LockedThreadPool
+{
+public:
+	explicit LockedThreadPool(std::size_t num_threads)
+	{
+		for (std::size_t i = 0; i < num_threads; ++i)
+		{
+			m_workers.emplace_back([this]
+			{
+				for (;;)
+				{
+					std::function<void()> task;
+
+					{
+						std::unique_lock<std::mutex> lock(m_queue_mutex);
+						m_condition.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+						if (m_stop && m_tasks.empty())
+						{
+							return;
+						}
+						task = std::move(m_tasks.front());
+						m_tasks.pop();
+					}
+
+					task();
+				}
+			});
+		}
+	}
+
+	~LockedThreadPool()
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_queue_mutex);
+			m_stop = true;
+		}
+
+		m_condition.notify_all();
+		for (auto& worker : m_workers)
+		{
+			worker.join();
+		}
+	}
+
+	template<typename F>
+	std::future<void> Enqueue(F&& f)
+	{
+		auto task = std::make_shared<std::packaged_task<void()>>(std::forward<F>(f));
+		auto retval = task->get_future();
+
+		{
+			std::unique_lock<std::mutex> lock(m_queue_mutex);
+			m_tasks.emplace([task]() { (*task)(); });
+		}
+		m_condition.notify_one();
+
+		return retval;
+	}
+
+private:
+	std::vector<std::thread> m_workers;
+	std::queue<std::function<void()>> m_tasks;
+	std::mutex m_queue_mutex;
+	std::condition_variable m_condition;
+	bool m_stop = false;
+};
+
+/*! One thread enqueues all tasks, like the frame graph dispatching its tasks. */
+template<typename P>
+void SingleProducer(P& pool)
+{
+	std::vector<decltype(pool.Enqueue([] {}))> futures;
+	futures.reserve(num_tasks);
+
+	for (std::size_t i = 0; i < num_tasks; ++i)
+	{
+		futures.push_back(pool.Enqueue([] {}));
+	}
+
+	for (auto& future : futures)
+	{
+		future.wait();
+	}
+}
+
+/*! As many threads as the pool has workers enqueue at the same time, like parallel asset loading. */
+template<typename P>
+void MultiProducer(P& pool, std::size_t num_producers)
+{
+	std::vector<std::thread> producers;
+
+	for (std::size_t p = 0; p < num_producers; ++p)
+	{
+		producers.emplace_back([&pool, num_producers]
+		{
+			std::vector<decltype(pool.Enqueue([] {}))> futures;
+			futures.reserve(num_tasks / num_producers);
+
+			for (std::size_t i = 0; i < num_tasks / num_producers; ++i)
+			{
+				futures.push_back(pool.Enqueue([] {}));
+			}
+
+			for (auto& future : futures)
+			{
+				future.wait();
+			}
+		});
+	}
+
+	for (auto& producer : producers)
+	{
+		producer.join();
+	}
+}
+
+/*! Tasks enqueue child tasks, like `FrameGraph::RecordParallel` called from a task. */
+template<typename P>
+void Nested(P& pool)
+{
+	std::atomic<std::size_t> num_finished = 0;
+	std::vector<decltype(pool.Enqueue([] {}))> futures;
+	futures.reserve(num_tasks / num_children);
+
+	for (std::size_t i = 0; i < num_tasks / num_children; ++i)
+	{
+		futures.push_back(pool.Enqueue([&pool, &num_finished]
+		{
+			// Waiting for the children here could block every worker, so they report back through a counter instead.
+			for (std::size_t c = 0; c < num_children; ++c)
+			{
+				pool.Enqueue([&num_finished] { num_finished.fetch_add(1, std::memory_order_relaxed); });
+			}
+		}));
+	}
+
+	for (auto& future : futures)
+	{
+		future.wait();
+	}
+
+	while (num_finished.load(std::memory_order_relaxed) != futures.size() * num_children)
+	{
+		std::this_thread::yield();
+	}
+}
+
+/*! Returns the best time of a few repetitions in milliseconds. */
+template<typename P, typename F>
+double Measure(std::size_t num_threads, F benchmark)
+{
+	P pool(num_threads);
+	double best = 0.0;
+
+	for (unsigned int i = 0; i < num_repetitions; ++i)
+	{
+		const auto begin = std::chrono::steady_clock::now();
+		benchmark(pool);
+		const auto end = std::chrono::steady_clock::now();
+
+		const auto ms = std::chrono::duration<double, std::milli>(end - begin).count();
+		best = (i == 0) ? ms : std::min(best, ms);
+	}
+
+	return best;
+}
+
+template<typename F>
+void Compare(const char* name, std::size_t num_threads, F benchmark)
+{
+	const auto locked_ms = Measure<LockedThreadPool>(num_threads, benchmark);
+	const auto stealing_ms = Measure<util::ThreadPool>(num_threads, benchmark);
+
+	std::printf("%-16s %8zu %14.2f %14.2f %9.2fx\n", name, num_threads, locked_ms, stealing_ms, locked_ms / stealing_ms);
+}
+
+int main()
+{
+	std::printf("%zu tasks, best of %u runs.\n", num_tasks, num_repetitions);
+	std::printf("%-16s %8s %14s %14s %10s\n", "Benchmark", "Threads", "Locked (ms)", "Stealing (ms)", "Speedup");
+
+	for (const auto num_threads : thread_counts)
+	{
+		Compare("single producer", num_threads, [](auto& pool) { SingleProducer(pool); });
+		Compare("multi producer", num_threads, [num_threads](auto& pool) { MultiProducer(pool, num_threads); });
+		Compare("nested", num_threads, [](auto& pool) { Nested(pool); });
+	}
+
+	return 0;
+}
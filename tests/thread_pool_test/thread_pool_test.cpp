@@ -0,0 +1,207 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "util/thread_pool.hpp"
+
+static bool g_success = true;
+
+static void Check(bool condition, char const * what)
+{
+	if (!condition)
+	{
+		std::printf("Failed: %s\n", what);
+		g_success = false;
+	}
+}
+
+static void TestReturnValues()
+{
+	util::ThreadPool pool(4);
+
+	std::vector<util::TaskFuture<int>> futures;
+	for (int i = 0; i < 5000; ++i)
+	{
+		futures.push_back(pool.Enqueue([](int value) { return value * 2; }, i));
+	}
+
+	bool correct = true;
+	for (int i = 0; i < 5000; ++i)
+	{
+		correct &= futures[i].get() == i * 2;
+	}
+	Check(correct, "every task returns its own value, also when more tasks are alive than the pool has slots for");
+}
+
+static void TestExceptionsReachTheToken()
+{
+	util::ThreadPool pool(2);
+
+	auto throwing = pool.Enqueue([]() -> int { throw std::runtime_error("task failed"); });
+	auto throwing_void = pool.Enqueue([] { throw 42; });
+
+	bool caught = false;
+	try
+	{
+		(void)throwing.get();
+	}
+	catch (std::runtime_error const & e)
+	{
+		caught = std::string(e.what()) == "task failed";
+	}
+	Check(caught, "get rethrows the exception of a task with a return value");
+	Check(!throwing.valid(), "get releases the token when it rethrows");
+
+	caught = false;
+	try
+	{
+		throwing_void.get();
+	}
+	catch (int value)
+	{
+		caught = value == 42;
+	}
+	Check(caught, "get rethrows the exception of a void task");
+
+	// The workers survive the exceptions.
+	Check(pool.Enqueue([] { return 7; }).get() == 7, "the pool keeps working after a task threw");
+}
+
+static void TestWaitFor()
+{
+	util::ThreadPool pool(1);
+	std::atomic<bool> release = false;
+
+	auto blocked = pool.Enqueue([&release]
+	{
+		while (!release.load())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	});
+
+	Check(blocked.wait_for(std::chrono::seconds(0)) == std::future_status::timeout, "a zero timeout polls an unfinished task");
+	Check(blocked.wait_for(std::chrono::milliseconds(20)) == std::future_status::timeout, "wait_for times out on an unfinished task");
+
+	std::thread releaser([&release]
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		release = true;
+	});
+	Check(blocked.wait_for(std::chrono::seconds(10)) == std::future_status::ready, "wait_for wakes up when the task finishes");
+	releaser.join();
+
+	Check(blocked.wait_for(std::chrono::seconds(0)) == std::future_status::ready, "a zero timeout reports a finished task");
+}
+
+static void TestPoolWithoutThreads()
+{
+	util::ThreadPool pool(0);
+
+	const auto caller = std::this_thread::get_id();
+	auto future = pool.Enqueue([] { return std::this_thread::get_id(); });
+
+	Check(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready, "a pool without threads finishes the task in Enqueue");
+	Check(future.get() == caller, "a pool without threads runs the task on the calling thread");
+}
+
+static void TestFullQueues()
+{
+	util::ThreadPool pool(1);
+	std::atomic<bool> release = false;
+
+	// Keep the only worker busy, so nothing drains the injection queue.
+	auto blocker = pool.Enqueue([&release]
+	{
+		while (!release.load())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	});
+
+	std::atomic<int> num_ran = 0;
+	const auto num_tasks = util::ThreadPool::injection_queue_capacity * 2;
+	for (std::size_t i = 0; i < num_tasks; ++i)
+	{
+		pool.Enqueue([&num_ran] { num_ran++; });
+	}
+	Check(num_ran.load() > 0, "tasks that don't fit in the queues run on the enqueueing thread");
+
+	release = true;
+	blocker.wait();
+	while (num_ran.load() != static_cast<int>(num_tasks))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	Check(num_ran.load() == static_cast<int>(num_tasks), "every task runs once");
+}
+
+static void TestEnqueueWhileStopping()
+{
+	std::atomic<bool> threw = false;
+	std::atomic<bool> started = false;
+
+	{
+		util::ThreadPool pool(1);
+
+		pool.Enqueue([&pool, &threw, &started]
+		{
+			started = true;
+
+			// Wait until the destructor stopped the pool.
+			for (int i = 0; i < 200; ++i)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+				try
+				{
+					pool.Enqueue([] {});
+				}
+				catch (std::runtime_error const &)
+				{
+					threw = true;
+					return;
+				}
+			}
+		});
+
+		while (!started.load())
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	Check(threw.load(), "enqueueing on a pool that is being destroyed throws");
+}
+
+int main()
+{
+	TestReturnValues();
+	TestExceptionsReachTheToken();
+	TestWaitFor();
+	TestPoolWithoutThreads();
+	TestFullQueues();
+	TestEnqueueWhileStopping();
+
+	std::printf(g_success ? "All thread pool tests passed.\n" : "Thread pool tests failed.\n");
+
+	return g_success ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+/*!
+ * Copyright 2019 Breda University of Applied Sciences and Team Wisp (Viktor Zoutman, Emilio Laiso, Jens Hagen, Meine Zeinstra, Tahar Meijs, Koen Buitenhuis, Niels Brunekreef, Darius Bouma, Florian Schut)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include "frame_graph/frame_graph.hpp"
+
+static const std::size_t num_task_types = 40;
+static const std::size_t num_lookups = 1'000'000;
+static const unsigned int num_repetitions = 5;
+
+/*! Distinct task data types, like the data structs of the render tasks. */
+template<std::size_t I>
+struct BenchmarkTaskData
+{
+	std::uint32_t m_value = 0;
+};
+
+/*! The previous lookup. Every task data type is compared with `typeid` until the task is found. */
+class TypeidScan
+{
+public:
+	template<typename T>
+	void Add()
+	{
+		m_data_type_info.push_back(typeid(T));
+	}
+
+	template<typename T>
+	bool HasTask() const
+	{
+		for (decltype(m_data_type_info.size()) i = 0; i < m_data_type_info.size(); ++i)
+		{
+			if (typeid(T) == m_data_type_info[i])
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+private:
+	std::vector<std::reference_wrapper<const std::type_info>> m_data_type_info;
+};
+
+template<std::size_t... Is>
+static void AddTasks(wr::FrameGraph& fg, TypeidScan& scan, std::index_sequence<Is...>)
+{
+	wr::RenderTaskDesc desc;
+	desc.m_setup_func = [](wr::RenderSystem&, wr::FrameGraph&, wr::RenderTaskHandle, bool) {};
+	desc.m_execute_func = [](wr::RenderSystem&, wr::FrameGraph&, wr::SceneGraph&, wr::RenderTaskHandle) {};
+	desc.m_destroy_func = [](wr::FrameGraph&, wr::RenderTaskHandle, bool) {};
+	desc.m_properties = std::nullopt;
+	desc.m_type = wr::RenderTaskType::DIRECT;
+
+	(fg.AddTask<BenchmarkTaskData<Is>>(desc, L"Benchmark Task"), ...);
+	(scan.Add<BenchmarkTaskData<Is>>(), ...);
+}
+
+/*! Look up every task once. Returns the number of tasks found so the lookups can't be optimized away. */
+template<typename F, std::size_t... Is>
+static std::uint64_t LookUpAll(F const & lookup, std::index_sequence<Is...>)
+{
+	std::uint64_t sum = 0;
+	((sum += lookup(BenchmarkTaskData<Is>()) ? 1 : 0), ...);
+	return sum;
+}
+
+template<typename F>
+static double Measure(F const & func, std::uint64_t& checksum)
+{
+	double best = 1e30;
+	for (unsigned int i = 0; i < num_repetitions; ++i)
+	{
+		std::uint64_t sum = 0;
+		const auto start = std::chrono::high_resolution_clock::now();
+		for (std::size_t lookup = 0; lookup < num_lookups / num_task_types; ++lookup)
+		{
+			sum += LookUpAll(func, std::make_index_sequence<num_task_types>());
+
+			// Keep the compiler from hoisting the lookups out of the loop.
+			std::atomic_signal_fence(std::memory_order_seq_cst);
+		}
+		const auto end = std::chrono::high_resolution_clock::now();
+
+		checksum = sum;
+		best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / num_lookups);
+	}
+	return best;
+}
+
+int main()
+{
+	wr::FrameGraph fg(num_task_types);
+	TypeidScan scan;
+	AddTasks(fg, scan, std::make_index_sequence<num_task_types>());
+
+	std::uint64_t typeid_checksum = 0;
+	std::uint64_t type_index_checksum = 0;
+
+	const auto typeid_ns = Measure([&scan](auto data)
+	{
+		return scan.HasTask<decltype(data)>();
+	}, typeid_checksum);
+
+	const auto type_index_ns = Measure([&fg](auto data)
+	{
+		return fg.HasTask<decltype(data)>();
+	}, type_index_checksum);
+
+	if (typeid_checksum != type_index_checksum || type_index_checksum != num_lookups)
+	{
+		std::printf("Not every task was found.\n");
+		return 1;
+	}
+
+	std::printf("Best of %u runs, %zu lookups over %zu task types.\n", num_repetitions, num_lookups, num_task_types);
+	std::printf("%-20s %14s %10s\n", "Lookup", "Time (ns)", "Speedup");
+	std::printf("%-20s %14.2f %9.2fx\n", "typeid scan", typeid_ns, 1.0);
+	std::printf("%-20s %14.2f %9.2fx\n", "Type index", type_index_ns, typeid_ns / type_index_ns);
+
+	return 0;
+}